@@ -0,0 +1,442 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+/*
+ * Runs both sources into fakesink sync=false over a matrix of
+ * configurations and prints one json-object per configuration and line.
+ *
+ * Every configuration runs in a forked child, so the peak rss is its own.
+ * Cpu-time and allocations are measured from the first to the last buffer
+ * arriving at the sink, which keeps negotiation and pre-rendering out of
+ * the per-buffer numbers.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <gst/gst.h>
+#include "avsynctestaudiokernels.h"
+
+/* allocation counting, by interposing the allocator of glibc */
+
+#ifdef __GLIBC__
+#define HAVE_ALLOC_COUNTING 1
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+
+static volatile gint allocations = 0;
+
+void *
+malloc (size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  return __libc_realloc (ptr, size);
+}
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+  g_atomic_int_inc (&allocations);
+  *memptr = __libc_memalign (alignment, size);
+  return *memptr ? 0 : ENOMEM;
+}
+#endif
+
+/* one configuration of the matrix */
+typedef struct
+{
+  const gchar *element;
+  gchar *pipeline;
+  /* frames or samples per channel in every buffer */
+  guint units_per_buffer;
+  gchar *params;
+} BenchCase;
+
+/* measurement snapshot */
+typedef struct
+{
+  gint64 wall;
+  gint64 cpu;
+  gint allocations;
+} BenchSnapshot;
+
+typedef struct
+{
+  guint buffers;
+  BenchSnapshot first;
+} BenchState;
+
+static gint num_buffers = 500;
+static gboolean quick = FALSE;
+static gchar *only_element = NULL;
+static gboolean verify = FALSE;
+
+static GOptionEntry entries[] = {
+  {"buffers", 'n', 0, G_OPTION_ARG_INT, &num_buffers, "Buffers per configuration (default 500)", "N"},
+  {"quick", 'q', 0, G_OPTION_ARG_NONE, &quick, "Run a reduced matrix", NULL},
+  {"element", 'e', 0, G_OPTION_ARG_STRING, &only_element, "Only run video or audio", "ELEMENT"},
+  {"verify", 0, 0, G_OPTION_ARG_NONE, &verify, "Verify the sample kernels against the scalar reference instead", NULL},
+  {NULL}
+};
+
+static void
+bench_snapshot (BenchSnapshot * snapshot)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  snapshot->wall = g_get_monotonic_time ();
+  snapshot->cpu = (gint64) usage.ru_utime.tv_sec * G_USEC_PER_SEC + usage.ru_utime.tv_usec +
+      (gint64) usage.ru_stime.tv_sec * G_USEC_PER_SEC + usage.ru_stime.tv_usec;
+#ifdef HAVE_ALLOC_COUNTING
+  snapshot->allocations = g_atomic_int_get (&allocations);
+#else
+  snapshot->allocations = 0;
+#endif
+}
+
+static GstPadProbeReturn
+bench_buffer_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  BenchState *state = user_data;
+
+  if (state->buffers++ == 0) {
+    bench_snapshot (&state->first);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* runs in the forked child, prints the result line and returns the exit code */
+static int
+bench_run (const BenchCase * bench_case)
+{
+  gst_init (NULL, NULL);
+
+  GError *error = NULL;
+  GstElement *pipeline = gst_parse_launch (bench_case->pipeline, &error);
+  if (!pipeline) {
+    g_printerr ("%s: %s\n", bench_case->pipeline, error->message);
+    g_clear_error (&error);
+    return 1;
+  }
+
+  // without a clock the live sources do not wait for their buffers to be due
+  gst_pipeline_use_clock (GST_PIPELINE (pipeline), NULL);
+
+  BenchState state = { 0, };
+  GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  GstPad *sinkpad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER, bench_buffer_probe, &state, NULL);
+  gst_object_unref (sinkpad);
+  gst_object_unref (sink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *message = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+
+  BenchSnapshot last;
+  bench_snapshot (&last);
+
+  int ret = 0;
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (message, &error, NULL);
+    g_printerr ("%s: %s\n", bench_case->pipeline, error->message);
+    g_clear_error (&error);
+    ret = 1;
+  }
+
+  gst_message_unref (message);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (ret != 0 || state.buffers < 2) {
+    return 1;
+  }
+
+  // intervals between the first and the last buffer
+  guint intervals = state.buffers - 1;
+  gdouble seconds = (last.wall - state.first.wall) / (gdouble) G_USEC_PER_SEC;
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  printf ("{\"element\": \"%s\", %s, \"buffers\": %u, \"seconds\": %.6f, "
+      "\"buffers_per_second\": %.2f, \"%s_per_second\": %.2f, "
+      "\"cpu_us_per_buffer\": %.3f, \"allocations_per_buffer\": %.3f, \"peak_rss_kb\": %ld}\n",
+      bench_case->element, bench_case->params, state.buffers, seconds,
+      intervals / seconds,
+      g_str_equal (bench_case->element, "video") ? "frames" : "samples",
+      (gdouble) intervals * bench_case->units_per_buffer / seconds,
+      (gdouble) (last.cpu - state.first.cpu) / intervals,
+#ifdef HAVE_ALLOC_COUNTING
+      (gdouble) (last.allocations - state.first.allocations) / intervals,
+#else
+      -1.0,
+#endif
+      usage.ru_maxrss);
+  fflush (stdout);
+
+  return 0;
+}
+
+static void
+bench_add_video_cases (GPtrArray * cases)
+{
+  static const struct { const gchar *name; gint width, height; } resolutions[] = {
+    {"SD", 720, 576},
+    {"HD", 1280, 720},
+    {"FHD", 1920, 1080},
+    {"UHD", 3840, 2160},
+    {"8K", 7680, 4320},
+  };
+  static const gint framerates[] = { 25, 60 };
+  static const gchar *formats[] = { "BGRx", "I420", "NV12", "UYVY", "v210" };
+  static const guint n_threads[] = { 1, 4 };
+
+  for (guint r = 0; r < G_N_ELEMENTS (resolutions); r++) {
+    for (guint f = 0; f < G_N_ELEMENTS (framerates); f++) {
+      for (guint v = 0; v < G_N_ELEMENTS (formats); v++) {
+        for (gint zero_copy = 0; zero_copy <= 1; zero_copy++) {
+          for (guint t = 0; t < G_N_ELEMENTS (n_threads); t++) {
+            if (quick && (f > 0 || v > 1 || r % 2 == 1)) {
+              continue;
+            }
+
+            // slicing only pays off for the big frames, and zero-copy does not copy at all
+            if (n_threads[t] > 1 && (resolutions[r].height < 2160 || zero_copy)) {
+              continue;
+            }
+
+            BenchCase *bench_case = g_new0 (BenchCase, 1);
+            bench_case->element = "video";
+            bench_case->units_per_buffer = 1;
+            bench_case->pipeline = g_strdup_printf (
+                "avsynctestvideosrc num-buffers=%d zero-copy=%d n-threads=%u ! "
+                "video/x-raw,format=%s,width=%d,height=%d,framerate=%d/1 ! "
+                "fakesink name=sink sync=false",
+                num_buffers, zero_copy, n_threads[t], formats[v], resolutions[r].width, resolutions[r].height, framerates[f]);
+            bench_case->params = g_strdup_printf (
+                "\"resolution\": \"%s\", \"width\": %d, \"height\": %d, \"framerate\": %d, "
+                "\"format\": \"%s\", \"zero_copy\": %s, \"n_threads\": %u",
+                resolutions[r].name, resolutions[r].width, resolutions[r].height, framerates[f],
+                formats[v], zero_copy ? "true" : "false", n_threads[t]);
+            g_ptr_array_add (cases, bench_case);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void
+bench_add_audio_cases (GPtrArray * cases)
+{
+  static const gint rates[] = { 44100, 48000, 96000 };
+  static const gint channels[] = { 1, 2, 16, 64 };
+  static const gchar *formats[] = { "S16LE", "S32LE", "F32LE" };
+  static const gint samples_per_buffer[] = { 64, 1024 };
+  static const gchar *waves[] = { "sawtooth", "sine", "sync-beep" };
+
+  for (guint r = 0; r < G_N_ELEMENTS (rates); r++) {
+    for (guint c = 0; c < G_N_ELEMENTS (channels); c++) {
+      for (guint f = 0; f < G_N_ELEMENTS (formats); f++) {
+        for (guint s = 0; s < G_N_ELEMENTS (samples_per_buffer); s++) {
+          for (guint w = 0; w < G_N_ELEMENTS (waves); w++) {
+            if (quick && (r != 1 || f == 1 || c % 2 == 1 || w != 0)) {
+              continue;
+            }
+
+            BenchCase *bench_case = g_new0 (BenchCase, 1);
+            bench_case->element = "audio";
+            bench_case->units_per_buffer = samples_per_buffer[s];
+            bench_case->pipeline = g_strdup_printf (
+                "avsynctestaudiosrc num-buffers=%d samples-per-buffer=%d wave=%s ! "
+                "audio/x-raw,format=%s,rate=%d,channels=%d,layout=interleaved ! "
+                "fakesink name=sink sync=false",
+                num_buffers, samples_per_buffer[s], waves[w], formats[f], rates[r], channels[c]);
+            bench_case->params = g_strdup_printf (
+                "\"rate\": %d, \"channels\": %d, \"format\": \"%s\", \"samples_per_buffer\": %d, "
+                "\"wave\": \"%s\"",
+                rates[r], channels[c], formats[f], samples_per_buffer[s], waves[w]);
+            g_ptr_array_add (cases, bench_case);
+          }
+        }
+      }
+    }
+  }
+}
+
+/* verification of the sample kernels, each has to be bit-exact with the scalar reference */
+
+/* odd, so the vector kernels run their tail as well */
+#define VERIFY_SAMPLES (1027)
+
+static guint
+verify_compare (const gint32 * reference, const gint32 * samples)
+{
+  for (guint i = 0; i < VERIFY_SAMPLES; i++) {
+    if (reference[i] != samples[i]) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* compares kernels over sweeps of the start and the increment, returns the number of differing runs */
+static guint
+verify_kernels (const GstAvSyncTestAudioKernels * kernels)
+{
+  static const guint32 phases[] = { 0, 1, 0x3FFFFFFF, 0x40000000, 0x7FFFFFFF, 0x80000000, 0xC0000000, 0xFFFFFFFF };
+  static const gint rates[] = { 8000, 44100, 48000, 96000, 192000 };
+  static const gdouble freqs[] = { 1.0, 50.0, 440.0, 997.0, 1000.0, 3999.5, 12345.0 };
+  static const guint32 extreme_incs[] = { 0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF };
+
+  const GstAvSyncTestAudioKernels *scalar = gst_avsynctest_audio_kernels_scalar ();
+  gint32 *reference = g_new (gint32, VERIFY_SAMPLES);
+  gint32 *samples = g_new (gint32, VERIFY_SAMPLES);
+  guint runs = 0, mismatches = 0;
+
+  for (guint counter = 0; counter < 256; counter++) {
+    scalar->sawtooth (reference, VERIFY_SAMPLES, (guint8) counter);
+    kernels->sawtooth (samples, VERIFY_SAMPLES, (guint8) counter);
+    mismatches += verify_compare (reference, samples);
+    runs++;
+  }
+
+  GArray *incs = g_array_new (FALSE, FALSE, sizeof (guint32));
+  g_array_append_vals (incs, extreme_incs, G_N_ELEMENTS (extreme_incs));
+  for (guint r = 0; r < G_N_ELEMENTS (rates); r++) {
+    for (guint f = 0; f < G_N_ELEMENTS (freqs); f++) {
+      guint32 inc = (guint32) (freqs[f] / rates[r] * 4294967296.0);
+      g_array_append_val (incs, inc);
+    }
+  }
+
+  // fixed seed, so a failing run can be repeated
+  GRand *rand = g_rand_new_with_seed (0x5EED);
+  for (guint i = 0; i < incs->len; i++) {
+    guint32 inc = g_array_index (incs, guint32, i);
+
+    for (guint p = 0; p < G_N_ELEMENTS (phases) + 8; p++) {
+      guint32 phase = p < G_N_ELEMENTS (phases) ? phases[p] : g_rand_int (rand);
+
+      scalar->sine (reference, VERIFY_SAMPLES, phase, inc);
+      kernels->sine (samples, VERIFY_SAMPLES, phase, inc);
+      mismatches += verify_compare (reference, samples);
+      runs++;
+    }
+  }
+
+  g_rand_free (rand);
+  g_array_unref (incs);
+  g_free (samples);
+  g_free (reference);
+
+  g_print ("{\"kernels\": \"%s\", \"runs\": %u, \"mismatches\": %u}\n", kernels->name, runs, mismatches);
+  return mismatches;
+}
+
+static int
+verify_all_kernels (void)
+{
+  guint failed = 0;
+
+  for (const GstAvSyncTestAudioKernels *const *kernels = gst_avsynctest_audio_kernels_list (); *kernels != NULL; kernels++) {
+    if (verify_kernels (*kernels) != 0) {
+      failed++;
+    }
+  }
+
+  return failed ? 1 : 0;
+}
+
+static void
+bench_case_free (gpointer data)
+{
+  BenchCase *bench_case = data;
+  g_free (bench_case->pipeline);
+  g_free (bench_case->params);
+  g_free (bench_case);
+}
+
+int
+main (int argc, char *argv[])
+{
+  GError *error = NULL;
+  GOptionContext *context = g_option_context_new ("- benchmark avsynctestvideosrc and avsynctestaudiosrc");
+  g_option_context_add_main_entries (context, entries, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    return 1;
+  }
+  g_option_context_free (context);
+
+  if (verify) {
+    return verify_all_kernels ();
+  }
+
+  GPtrArray *cases = g_ptr_array_new_with_free_func (bench_case_free);
+  if (!only_element || g_str_equal (only_element, "video")) {
+    bench_add_video_cases (cases);
+  }
+  if (!only_element || g_str_equal (only_element, "audio")) {
+    bench_add_audio_cases (cases);
+  }
+
+  int failed = 0;
+  for (guint i = 0; i < cases->len; i++) {
+    pid_t pid = fork ();
+    if (pid == 0) {
+      _exit (bench_run (g_ptr_array_index (cases, i)));
+    }
+
+    int status;
+    if (pid < 0 || waitpid (pid, &status, 0) < 0 || !WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+      failed++;
+    }
+  }
+
+  g_ptr_array_unref (cases);
+  return failed ? 1 : 0;
+}
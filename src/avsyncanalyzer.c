@@ -0,0 +1,644 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "avsyncanalyzer.h"
+#include "avsynctestrender.h"
+
+/* pad templates */
+static GstStaticPadTemplate video_sinktemplate = GST_STATIC_PAD_TEMPLATE ("video_sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw,format=" GST_AV_SYNC_TEST_RENDER_FORMATS)
+);
+
+static GstStaticPadTemplate audio_sinktemplate = GST_STATIC_PAD_TEMPLATE ("audio_sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("audio/x-raw,format={ " GST_AUDIO_NE (S16) ", " GST_AUDIO_NE (S32) ", " GST_AUDIO_NE (F32) " },"
+        "layout={ interleaved, non-interleaved },"
+        "rate=[ 1, MAX ],"
+        "channels=[ 1, MAX ]")
+);
+
+GST_DEBUG_CATEGORY_STATIC (gst_avsyncanalyzer_debug);
+#define GST_CAT_DEFAULT gst_avsyncanalyzer_debug
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_VIDEO_THRESHOLD,
+  PROP_AUDIO_THRESHOLD,
+  PROP_OFFSET,
+  PROP_SYNC_POINTS,
+};
+
+/* property defaults */
+#define PROP_VIDEO_THRESHOLD_DEFAULT (0.25)
+#define PROP_AUDIO_THRESHOLD_DEFAULT (0.1)
+
+/* samples per direction taken from the inner half of the flash-rectangle */
+#define FLASH_SAMPLES (16)
+
+/* frames within the threshold of each other that seed the baseline, a flash never lasts that long */
+#define BASELINE_FRAMES (3)
+
+/* a run of deviating frames longer than this is a change of the background, not a flash */
+#define MAX_FLASH_FRAMES (5)
+
+/* silence required in front of a burst, to not trigger again within the burst */
+#define AUDIO_HOLDOFF (GST_SECOND / 10)
+
+/* sync-points are one sync-interval apart, one second by default, flash and burst further apart are not paired */
+#define MAX_OFFSET (GST_SECOND / 2)
+
+/* parent class */
+#define gst_avsyncanalyzer_parent_class parent_class
+G_DEFINE_TYPE (GstAvSyncAnalyzer, gst_avsyncanalyzer, GST_TYPE_ELEMENT);
+
+/* GObject member methods */
+static void gst_avsyncanalyzer_set_property (GObject * object, guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_avsyncanalyzer_get_property (GObject * object, guint prop_id, GValue * value, GParamSpec * pspec);
+
+/* GstElement member methods */
+static GstStateChangeReturn gst_avsyncanalyzer_change_state (GstElement * element, GstStateChange transition);
+
+/* pad functions */
+static GstFlowReturn gst_avsyncanalyzer_video_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer);
+static gboolean gst_avsyncanalyzer_video_event (GstPad * pad, GstObject * parent, GstEvent * event);
+static GstFlowReturn gst_avsyncanalyzer_audio_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer);
+static gboolean gst_avsyncanalyzer_audio_event (GstPad * pad, GstObject * parent, GstEvent * event);
+
+static void
+gst_avsyncanalyzer_class_init (GstAvSyncAnalyzerClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  element_class->change_state = GST_DEBUG_FUNCPTR (gst_avsyncanalyzer_change_state);
+
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->set_property = gst_avsyncanalyzer_set_property;
+  gobject_class->get_property = gst_avsyncanalyzer_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_VIDEO_THRESHOLD,
+      g_param_spec_double ("video-threshold", "Video-Threshold",
+          "Change of the luma in the flash-rectangle, relative to full scale, that is detected as flash.",
+          0.0, 1.0,
+          PROP_VIDEO_THRESHOLD_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_AUDIO_THRESHOLD,
+      g_param_spec_double ("audio-threshold", "Audio-Threshold",
+          "Level of the first channel, relative to full scale, that is detected as start of a sync-burst.",
+          0.0, 1.0,
+          PROP_AUDIO_THRESHOLD_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_OFFSET,
+      g_param_spec_int64 ("offset", "Offset",
+          "Offset of the audio relative to the video at the last sync-point in ns. Positive when the audio is late.",
+          G_MININT64, G_MAXINT64,
+          0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_POINTS,
+      g_param_spec_uint64 ("sync-points", "Sync-Points",
+          "Number of sync-points measured so far.",
+          0, G_MAXUINT64,
+          0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  GST_DEBUG_CATEGORY_INIT (gst_avsyncanalyzer_debug, "avsyncanalyzer", 0, "AV Sync-Analyzer");
+
+  gst_element_class_add_static_pad_template (element_class, &video_sinktemplate);
+  gst_element_class_add_static_pad_template (element_class, &audio_sinktemplate);
+
+  gst_element_class_set_static_metadata (element_class, "AV Sync-Analyzer",
+      "Sink/Analyzer/Audio/Video",
+      "Measures the A/V offset of the AV Sync-Test Signal at every sync-point.",
+      "Peter Körner <peter@mazdermind.de>");
+}
+
+static void
+gst_avsyncanalyzer_reset_video (GstAvSyncAnalyzer * self)
+{
+  gst_segment_init (&self->video_segment, GST_FORMAT_TIME);
+  self->video_baseline_frames = 0;
+  self->flash_start = GST_CLOCK_TIME_NONE;
+  self->flash_frames = 0;
+  self->flash_weight = 0.0;
+  self->flash_weighted_offset = 0.0;
+}
+
+static void
+gst_avsyncanalyzer_reset_audio (GstAvSyncAnalyzer * self)
+{
+  gst_segment_init (&self->audio_segment, GST_FORMAT_TIME);
+
+  // require a full holdoff of silence, a stream might start in the middle of a burst
+  self->audio_quiet_samples = 0;
+}
+
+static void
+gst_avsyncanalyzer_reset (GstAvSyncAnalyzer * self)
+{
+  gst_avsyncanalyzer_reset_video (self);
+  gst_avsyncanalyzer_reset_audio (self);
+
+  GST_OBJECT_LOCK (self);
+  self->pending_video = GST_CLOCK_TIME_NONE;
+  self->pending_audio = GST_CLOCK_TIME_NONE;
+  self->offset = 0;
+  self->sync_points = 0;
+  self->video_eos = FALSE;
+  self->audio_eos = FALSE;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_avsyncanalyzer_init (GstAvSyncAnalyzer * avsyncanalyzer)
+{
+  GST_DEBUG_OBJECT (avsyncanalyzer, "init");
+
+  avsyncanalyzer->video_threshold = PROP_VIDEO_THRESHOLD_DEFAULT;
+  avsyncanalyzer->audio_threshold = PROP_AUDIO_THRESHOLD_DEFAULT;
+
+  avsyncanalyzer->video_sinkpad = gst_pad_new_from_static_template (&video_sinktemplate, "video_sink");
+  gst_pad_set_chain_function (avsyncanalyzer->video_sinkpad, GST_DEBUG_FUNCPTR (gst_avsyncanalyzer_video_chain));
+  gst_pad_set_event_function (avsyncanalyzer->video_sinkpad, GST_DEBUG_FUNCPTR (gst_avsyncanalyzer_video_event));
+  gst_element_add_pad (GST_ELEMENT (avsyncanalyzer), avsyncanalyzer->video_sinkpad);
+
+  avsyncanalyzer->audio_sinkpad = gst_pad_new_from_static_template (&audio_sinktemplate, "audio_sink");
+  gst_pad_set_chain_function (avsyncanalyzer->audio_sinkpad, GST_DEBUG_FUNCPTR (gst_avsyncanalyzer_audio_chain));
+  gst_pad_set_event_function (avsyncanalyzer->audio_sinkpad, GST_DEBUG_FUNCPTR (gst_avsyncanalyzer_audio_event));
+  gst_element_add_pad (GST_ELEMENT (avsyncanalyzer), avsyncanalyzer->audio_sinkpad);
+
+  // the pipeline waits for our eos-message
+  GST_OBJECT_FLAG_SET (avsyncanalyzer, GST_ELEMENT_FLAG_SINK);
+
+  gst_avsyncanalyzer_reset (avsyncanalyzer);
+}
+
+void
+gst_avsyncanalyzer_set_property (GObject * object, guint property_id, const GValue * value, GParamSpec * pspec)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (object);
+
+  switch (property_id) {
+    case PROP_VIDEO_THRESHOLD:
+      avsyncanalyzer->video_threshold = g_value_get_double(value);
+      break;
+
+    case PROP_AUDIO_THRESHOLD:
+      avsyncanalyzer->audio_threshold = g_value_get_double(value);
+      break;
+
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (avsyncanalyzer, property_id, pspec);
+      break;
+  }
+}
+
+void
+gst_avsyncanalyzer_get_property (GObject * object, guint property_id, GValue * value, GParamSpec * pspec)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (object);
+
+  switch (property_id) {
+    case PROP_VIDEO_THRESHOLD:
+      g_value_set_double (value, avsyncanalyzer->video_threshold);
+      break;
+
+    case PROP_AUDIO_THRESHOLD:
+      g_value_set_double (value, avsyncanalyzer->audio_threshold);
+      break;
+
+    case PROP_OFFSET:
+      GST_OBJECT_LOCK (avsyncanalyzer);
+      g_value_set_int64 (value, avsyncanalyzer->offset);
+      GST_OBJECT_UNLOCK (avsyncanalyzer);
+      break;
+
+    case PROP_SYNC_POINTS:
+      GST_OBJECT_LOCK (avsyncanalyzer);
+      g_value_set_uint64 (value, avsyncanalyzer->sync_points);
+      GST_OBJECT_UNLOCK (avsyncanalyzer);
+      break;
+
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (avsyncanalyzer, property_id, pspec);
+      break;
+  }
+}
+
+static GstStateChangeReturn
+gst_avsyncanalyzer_change_state (GstElement * element, GstStateChange transition)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (element);
+
+  if (transition == GST_STATE_CHANGE_READY_TO_PAUSED) {
+    gst_avsyncanalyzer_reset (avsyncanalyzer);
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+}
+
+/*
+ * Called with the running-time of a flash or a burst. Pairs it with the
+ * pending event of the other side, or keeps it pending until that arrives.
+ */
+static void
+gst_avsyncanalyzer_sync_point (GstAvSyncAnalyzer * self, GstClockTime running_time, gboolean is_video)
+{
+  GST_OBJECT_LOCK (self);
+  GstClockTime video_time = is_video ? running_time : self->pending_video;
+  GstClockTime audio_time = is_video ? self->pending_audio : running_time;
+
+  if (!GST_CLOCK_TIME_IS_VALID (video_time) || !GST_CLOCK_TIME_IS_VALID (audio_time) ||
+      ABS (GST_CLOCK_DIFF (video_time, audio_time)) > MAX_OFFSET) {
+    // an older, unpaired event of the same side is superseded
+    if (is_video) {
+      self->pending_video = running_time;
+    } else {
+      self->pending_audio = running_time;
+    }
+
+    GST_OBJECT_UNLOCK (self);
+    return;
+  }
+
+  gint64 offset = GST_CLOCK_DIFF (video_time, audio_time);
+  self->pending_video = GST_CLOCK_TIME_NONE;
+  self->pending_audio = GST_CLOCK_TIME_NONE;
+  self->offset = offset;
+  guint64 index = ++self->sync_points;
+  GST_OBJECT_UNLOCK (self);
+
+  GST_INFO_OBJECT (self, "sync-point %" G_GUINT64_FORMAT ": video %" GST_TIME_FORMAT ", audio %" GST_TIME_FORMAT
+      ", offset %" G_GINT64_FORMAT " ns", index, GST_TIME_ARGS (video_time), GST_TIME_ARGS (audio_time), offset);
+
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_structure_new ("avsyncanalyzer",
+              "sync-point", G_TYPE_UINT64, index,
+              "offset", G_TYPE_INT64, offset,
+              "video-running-time", G_TYPE_UINT64, video_time,
+              "audio-running-time", G_TYPE_UINT64, audio_time,
+              NULL)));
+}
+
+static void
+gst_avsyncanalyzer_pad_eos (GstAvSyncAnalyzer * self, gboolean is_video)
+{
+  GST_OBJECT_LOCK (self);
+  if (is_video) {
+    self->video_eos = TRUE;
+  } else {
+    self->audio_eos = TRUE;
+  }
+  gboolean eos = self->video_eos && self->audio_eos;
+  GST_OBJECT_UNLOCK (self);
+
+  if (eos) {
+    GST_DEBUG_OBJECT (self, "eos on both pads");
+    gst_element_post_message (GST_ELEMENT (self), gst_message_new_eos (GST_OBJECT (self)));
+  }
+}
+
+static void
+gst_avsyncanalyzer_pad_flush (GstAvSyncAnalyzer * self, gboolean is_video)
+{
+  GST_OBJECT_LOCK (self);
+  if (is_video) {
+    self->video_eos = FALSE;
+    self->pending_video = GST_CLOCK_TIME_NONE;
+  } else {
+    self->audio_eos = FALSE;
+    self->pending_audio = GST_CLOCK_TIME_NONE;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* video */
+
+static gboolean
+gst_avsyncanalyzer_video_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      gst_event_parse_caps (event, &caps);
+      if (!gst_video_info_from_caps (&avsyncanalyzer->video_info, caps)) {
+        GST_ERROR_OBJECT (avsyncanalyzer, "invalid video caps %" GST_PTR_FORMAT, caps);
+        gst_event_unref (event);
+        return FALSE;
+      }
+      break;
+    }
+
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &avsyncanalyzer->video_segment);
+      break;
+
+    case GST_EVENT_FLUSH_STOP:
+      gst_avsyncanalyzer_reset_video (avsyncanalyzer);
+      gst_avsyncanalyzer_pad_flush (avsyncanalyzer, TRUE);
+      break;
+
+    case GST_EVENT_EOS:
+      gst_avsyncanalyzer_pad_eos (avsyncanalyzer, TRUE);
+      break;
+
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+/* mean luma of a grid of samples from the inner half of the flash-rectangle, relative to full scale */
+static gdouble
+gst_avsyncanalyzer_flash_luma (const GstVideoFrame * frame)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+
+  // keep clear of the outline and of edges blurred by scaling
+  gdouble left = (GST_AV_SYNC_TEST_FLASH_LEFT + GST_AV_SYNC_TEST_FLASH_WIDTH / 4) * width;
+  gdouble top = (GST_AV_SYNC_TEST_FLASH_TOP + GST_AV_SYNC_TEST_FLASH_HEIGHT / 4) * height;
+  gdouble step_x = GST_AV_SYNC_TEST_FLASH_WIDTH / 2 * width / FLASH_SAMPLES;
+  gdouble step_y = GST_AV_SYNC_TEST_FLASH_HEIGHT / 2 * height / FLASH_SAMPLES;
+
+  guint sum = 0;
+  for (gint j = 0; j < FLASH_SAMPLES; j++) {
+    gint y = CLAMP ((gint) (top + j * step_y), 0, height - 1);
+
+    for (gint i = 0; i < FLASH_SAMPLES; i++) {
+      gint x = CLAMP ((gint) (left + i * step_x), 0, width - 1);
+      sum += gst_avsynctest_luma_at (frame, x, y);
+    }
+  }
+
+  return sum / (255.0 * FLASH_SAMPLES * FLASH_SAMPLES);
+}
+
+static void
+gst_avsyncanalyzer_drop_flash (GstAvSyncAnalyzer * self)
+{
+  self->flash_start = GST_CLOCK_TIME_NONE;
+  self->flash_frames = 0;
+  self->flash_weight = 0.0;
+  self->flash_weighted_offset = 0.0;
+}
+
+/*
+ * The baseline is only trusted once BASELINE_FRAMES frames in a row agree
+ * with it, so a stream starting on a flash, like the test-signal does on
+ * sync-point 0, does not take the flash for the background.
+ */
+static gboolean
+gst_avsyncanalyzer_seed_baseline (GstAvSyncAnalyzer * self, gdouble luma)
+{
+  if (self->video_baseline_frames >= BASELINE_FRAMES) {
+    return TRUE;
+  }
+
+  if (self->video_baseline_frames == 0 || fabs (luma - self->video_baseline) >= self->video_threshold) {
+    self->video_baseline = luma;
+    self->video_baseline_frames = 1;
+    return FALSE;
+  }
+
+  self->video_baseline_frames++;
+  self->video_baseline += (luma - self->video_baseline) / self->video_baseline_frames;
+  return self->video_baseline_frames >= BASELINE_FRAMES;
+}
+
+/*
+ * A flash is a run of frames whose luma deviates from the baseline by more
+ * than the threshold. Its time is the centroid of the run, weighted by the
+ * deviation, which locates a flash blended across frames (by a frame-rate
+ * conversion or a deinterlacer) in between them. A run longer than
+ * MAX_FLASH_FRAMES is dropped and the baseline seeded anew.
+ */
+static void
+gst_avsyncanalyzer_analyze_video (GstAvSyncAnalyzer * self, gdouble luma, GstClockTime running_time)
+{
+  if (!gst_avsyncanalyzer_seed_baseline (self, luma)) {
+    return;
+  }
+
+  gdouble deviation = fabs (luma - self->video_baseline);
+
+  if (deviation >= self->video_threshold) {
+    if (!GST_CLOCK_TIME_IS_VALID (self->flash_start)) {
+      self->flash_start = running_time;
+    }
+
+    if (++self->flash_frames > MAX_FLASH_FRAMES) {
+      GST_DEBUG_OBJECT (self, "luma stayed off the baseline for %u frames, seeding it anew", self->flash_frames);
+      gst_avsyncanalyzer_drop_flash (self);
+      self->video_baseline = luma;
+      self->video_baseline_frames = 1;
+      return;
+    }
+
+    self->flash_weight += deviation;
+    self->flash_weighted_offset += deviation * (running_time - self->flash_start);
+    return;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (self->flash_start)) {
+    GstClockTime flash_time = self->flash_start + (GstClockTime) llround (self->flash_weighted_offset / self->flash_weight);
+    GST_DEBUG_OBJECT (self, "flash at %" GST_TIME_FORMAT, GST_TIME_ARGS (flash_time));
+
+    gst_avsyncanalyzer_drop_flash (self);
+
+    gst_avsyncanalyzer_sync_point (self, flash_time, TRUE);
+  }
+
+  // follow slow changes of the background, but never the flash itself
+  self->video_baseline += (luma - self->video_baseline) / 8;
+}
+
+static GstFlowReturn
+gst_avsyncanalyzer_video_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (parent);
+
+  GstClockTime running_time = gst_segment_to_running_time (&avsyncanalyzer->video_segment,
+      GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
+
+  if (!GST_CLOCK_TIME_IS_VALID (running_time)) {
+    GST_LOG_OBJECT (avsyncanalyzer, "skipping video buffer without running-time");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+
+  GstVideoFrame frame;
+  if (!gst_video_frame_map (&frame, &avsyncanalyzer->video_info, buffer, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (avsyncanalyzer, "failed to map video buffer");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_ERROR;
+  }
+
+  gdouble luma = gst_avsyncanalyzer_flash_luma (&frame);
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unref (buffer);
+
+  gst_avsyncanalyzer_analyze_video (avsyncanalyzer, luma, running_time);
+
+  return GST_FLOW_OK;
+}
+
+/* audio */
+
+static gboolean
+gst_avsyncanalyzer_audio_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      gst_event_parse_caps (event, &caps);
+      if (!gst_audio_info_from_caps (&avsyncanalyzer->audio_info, caps)) {
+        GST_ERROR_OBJECT (avsyncanalyzer, "invalid audio caps %" GST_PTR_FORMAT, caps);
+        gst_event_unref (event);
+        return FALSE;
+      }
+      break;
+    }
+
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &avsyncanalyzer->audio_segment);
+      break;
+
+    case GST_EVENT_FLUSH_STOP:
+      gst_avsyncanalyzer_reset_audio (avsyncanalyzer);
+      gst_avsyncanalyzer_pad_flush (avsyncanalyzer, FALSE);
+      break;
+
+    case GST_EVENT_EOS:
+      gst_avsyncanalyzer_pad_eos (avsyncanalyzer, FALSE);
+      break;
+
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static void
+gst_avsyncanalyzer_audio_onset (GstAvSyncAnalyzer * self, GstClockTime pts, guint index)
+{
+  GstClockTime onset = pts + gst_util_uint64_scale_int (index, GST_SECOND, GST_AUDIO_INFO_RATE (&self->audio_info));
+  GstClockTime running_time = gst_segment_to_running_time (&self->audio_segment, GST_FORMAT_TIME, onset);
+
+  if (GST_CLOCK_TIME_IS_VALID (running_time)) {
+    GST_DEBUG_OBJECT (self, "burst at %" GST_TIME_FORMAT, GST_TIME_ARGS (running_time));
+    gst_avsyncanalyzer_sync_point (self, running_time, FALSE);
+  }
+}
+
+/*
+ * Streaming onset detector on the first channel: a burst starts with the
+ * first sample above the threshold after at least AUDIO_HOLDOFF of samples
+ * below it. Only a compare per sample, the quiet-counter carries across
+ * buffers.
+ */
+#define SCAN_ONSETS(ctype, limit) \
+{ \
+  const ctype *s = (const ctype *) samples; \
+  for (guint i = 0; i < num_samples; i++) { \
+    ctype v = s[i * stride]; \
+    if (v < (limit) && v > -(limit)) { \
+      self->audio_quiet_samples++; \
+      continue; \
+    } \
+    if (self->audio_quiet_samples >= holdoff) { \
+      gst_avsyncanalyzer_audio_onset (self, pts, i); \
+    } \
+    self->audio_quiet_samples = 0; \
+  } \
+}
+
+static void
+gst_avsyncanalyzer_analyze_audio (GstAvSyncAnalyzer * self, const guint8 * samples, guint stride, guint num_samples, GstClockTime pts)
+{
+  guint64 holdoff = gst_util_uint64_scale_int (AUDIO_HOLDOFF, GST_AUDIO_INFO_RATE (&self->audio_info), GST_SECOND);
+  gdouble threshold = self->audio_threshold;
+
+  switch (GST_AUDIO_INFO_FORMAT (&self->audio_info)) {
+    case GST_AUDIO_FORMAT_S16:
+      SCAN_ONSETS (gint16, (gint) (threshold * G_MAXINT16));
+      break;
+
+    case GST_AUDIO_FORMAT_S32:
+      SCAN_ONSETS (gint32, (gint32) (threshold * G_MAXINT32));
+      break;
+
+    default:
+      SCAN_ONSETS (gfloat, (gfloat) threshold);
+      break;
+  }
+}
+
+static GstFlowReturn
+gst_avsyncanalyzer_audio_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstAvSyncAnalyzer *avsyncanalyzer = GST_AV_SYNC_ANALYZER (parent);
+  GstClockTime pts = GST_BUFFER_PTS (buffer);
+
+  if (!GST_CLOCK_TIME_IS_VALID (pts)) {
+    GST_LOG_OBJECT (avsyncanalyzer, "skipping audio buffer without timestamp");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_OK;
+  }
+
+  GstAudioBuffer audio_buffer;
+  if (!gst_audio_buffer_map (&audio_buffer, &avsyncanalyzer->audio_info, buffer, GST_MAP_READ)) {
+    GST_ERROR_OBJECT (avsyncanalyzer, "failed to map audio buffer");
+    gst_buffer_unref (buffer);
+    return GST_FLOW_ERROR;
+  }
+
+  // the first plane starts with the first channel in both layouts
+  guint stride = GST_AUDIO_INFO_LAYOUT (&avsyncanalyzer->audio_info) == GST_AUDIO_LAYOUT_INTERLEAVED ?
+      GST_AUDIO_INFO_CHANNELS (&avsyncanalyzer->audio_info) : 1;
+
+  gst_avsyncanalyzer_analyze_audio (avsyncanalyzer, audio_buffer.planes[0], stride, audio_buffer.n_samples, pts);
+
+  gst_audio_buffer_unmap (&audio_buffer);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
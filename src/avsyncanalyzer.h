@@ -0,0 +1,78 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_ANALYZER_H_
+#define _GST_AV_SYNC_ANALYZER_H_
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/audio/audio.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_AV_SYNC_ANALYZER           (gst_avsyncanalyzer_get_type())
+#define GST_AV_SYNC_ANALYZER(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_AV_SYNC_ANALYZER, GstAvSyncAnalyzer))
+#define GST_AV_SYNC_ANALYZER_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),  GST_TYPE_AV_SYNC_ANALYZER, GstAvSyncAnalyzerClass))
+#define GST_IS_AV_SYNC_ANALYZER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_AV_SYNC_ANALYZER))
+#define GST_IS_AV_SYNC_ANALYZER_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE((klass),  GST_TYPE_AV_SYNC_ANALYZER))
+typedef struct _GstAvSyncAnalyzer GstAvSyncAnalyzer;
+typedef struct _GstAvSyncAnalyzerClass GstAvSyncAnalyzerClass;
+
+struct _GstAvSyncAnalyzer
+{
+  GstElement base_avsyncanalyzer;
+
+  GstPad *video_sinkpad;
+  GstPad *audio_sinkpad;
+
+  gdouble video_threshold;
+  gdouble audio_threshold;
+
+  // video side, only touched from the video streaming thread
+  GstVideoInfo video_info;
+  GstSegment video_segment;
+  gdouble video_baseline;
+  // frames agreeing with the baseline while it is seeded, it is valid from BASELINE_FRAMES on
+  guint video_baseline_frames;
+  GstClockTime flash_start;
+  guint flash_frames;
+  gdouble flash_weight;
+  gdouble flash_weighted_offset;
+
+  // audio side, only touched from the audio streaming thread
+  GstAudioInfo audio_info;
+  GstSegment audio_segment;
+  guint64 audio_quiet_samples;
+
+  // shared between both sides, protected by the object lock
+  GstClockTime pending_video;
+  GstClockTime pending_audio;
+  gint64 offset;
+  guint64 sync_points;
+  gboolean video_eos;
+  gboolean audio_eos;
+};
+
+struct _GstAvSyncAnalyzerClass
+{
+  GstElementClass base_avsyncanalyzer_class;
+};
+
+GType gst_avsyncanalyzer_get_type (void);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_ANALYZER_H_
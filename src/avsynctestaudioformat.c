@@ -0,0 +1,147 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "avsynctestaudioformat.h"
+
+/* conversions from the internal precision into the sample formats */
+#define TO_S16(s) ((guint16) ((s) >> 16))
+#define TO_S24(s) ((guint32) ((s) >> 8))
+#define TO_S32(s) ((guint32) (s))
+#define TO_F32(s) ((gfloat) (s) * (1.0f / 2147483648.0f))
+#define TO_F64(s) ((gdouble) (s) * (1.0 / 2147483648.0))
+
+#define DEFINE_PACK_FUNC(name, width, write, convert) \
+static void \
+gst_avsynctest_audio_pack_##name (guint8 * dest, const gint32 * src, guint n) \
+{ \
+  for (guint i = 0; i < n; i++) { \
+    write (dest + i * (width), convert (src[i])); \
+  } \
+}
+
+DEFINE_PACK_FUNC (s16le, 2, GST_WRITE_UINT16_LE, TO_S16)
+DEFINE_PACK_FUNC (s16be, 2, GST_WRITE_UINT16_BE, TO_S16)
+DEFINE_PACK_FUNC (s24le, 3, GST_WRITE_UINT24_LE, TO_S24)
+DEFINE_PACK_FUNC (s24be, 3, GST_WRITE_UINT24_BE, TO_S24)
+DEFINE_PACK_FUNC (s32le, 4, GST_WRITE_UINT32_LE, TO_S32)
+DEFINE_PACK_FUNC (s32be, 4, GST_WRITE_UINT32_BE, TO_S32)
+DEFINE_PACK_FUNC (f32le, 4, GST_WRITE_FLOAT_LE, TO_F32)
+DEFINE_PACK_FUNC (f32be, 4, GST_WRITE_FLOAT_BE, TO_F32)
+DEFINE_PACK_FUNC (f64le, 8, GST_WRITE_DOUBLE_LE, TO_F64)
+DEFINE_PACK_FUNC (f64be, 8, GST_WRITE_DOUBLE_BE, TO_F64)
+
+/* NULL for formats not listed in GST_AV_SYNC_TEST_AUDIO_FORMATS */
+GstAvSyncTestAudioPackFunc
+gst_avsynctest_audio_pack_func (GstAudioFormat format)
+{
+  switch (format) {
+    case GST_AUDIO_FORMAT_S16LE:
+      return gst_avsynctest_audio_pack_s16le;
+    case GST_AUDIO_FORMAT_S16BE:
+      return gst_avsynctest_audio_pack_s16be;
+    case GST_AUDIO_FORMAT_S24LE:
+      return gst_avsynctest_audio_pack_s24le;
+    case GST_AUDIO_FORMAT_S24BE:
+      return gst_avsynctest_audio_pack_s24be;
+    case GST_AUDIO_FORMAT_S32LE:
+      return gst_avsynctest_audio_pack_s32le;
+    case GST_AUDIO_FORMAT_S32BE:
+      return gst_avsynctest_audio_pack_s32be;
+    case GST_AUDIO_FORMAT_F32LE:
+      return gst_avsynctest_audio_pack_f32le;
+    case GST_AUDIO_FORMAT_F32BE:
+      return gst_avsynctest_audio_pack_f32be;
+    case GST_AUDIO_FORMAT_F64LE:
+      return gst_avsynctest_audio_pack_f64le;
+    case GST_AUDIO_FORMAT_F64BE:
+      return gst_avsynctest_audio_pack_f64be;
+    default:
+      return NULL;
+  }
+}
+
+/*
+ * Start of a channel in a buffer of num_samples samples per channel. Planar
+ * buffers carry their planes back to back, as described by the default
+ * GstAudioMeta for that layout.
+ */
+guint8 *
+gst_avsynctest_audio_channel_data (const GstAudioInfo * info, guint8 * data, guint num_samples, guint channel)
+{
+  gsize bps = GST_AUDIO_INFO_BPS (info);
+
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    return data + (gsize) channel * num_samples * bps;
+  }
+
+  return data + channel * bps;
+}
+
+static inline void
+gst_avsynctest_audio_scatter (guint8 * dest, gsize stride, const guint8 * packed, guint num_samples, gsize bps)
+{
+  for (guint i = 0; i < num_samples; i++) {
+    memcpy (dest + i * stride, packed + i * bps, bps);
+  }
+}
+
+/*
+ * Copies densely packed samples into one channel of a buffer. The sample
+ * size is passed as a constant per case, so the compiler can turn the
+ * copies into plain loads and stores.
+ */
+void
+gst_avsynctest_audio_fan_out (const GstAudioInfo * info, guint8 * data, guint num_samples, const guint8 * packed, guint channel)
+{
+  gsize bps = GST_AUDIO_INFO_BPS (info);
+  gsize stride = GST_AUDIO_INFO_BPF (info);
+  guint8 *dest = gst_avsynctest_audio_channel_data (info, data, num_samples, channel);
+
+  if (dest == packed) {
+    return;
+  }
+
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    memcpy (dest, packed, num_samples * bps);
+    return;
+  }
+
+  switch (bps) {
+    case 2:
+      gst_avsynctest_audio_scatter (dest, stride, packed, num_samples, 2);
+      break;
+    case 3:
+      gst_avsynctest_audio_scatter (dest, stride, packed, num_samples, 3);
+      break;
+    case 4:
+      gst_avsynctest_audio_scatter (dest, stride, packed, num_samples, 4);
+      break;
+    case 8:
+      gst_avsynctest_audio_scatter (dest, stride, packed, num_samples, 8);
+      break;
+    default:
+      gst_avsynctest_audio_scatter (dest, stride, packed, num_samples, bps);
+      break;
+  }
+}
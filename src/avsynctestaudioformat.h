@@ -0,0 +1,44 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_AUDIO_FORMAT_H_
+#define _GST_AV_SYNC_TEST_AUDIO_FORMAT_H_
+
+#include <gst/audio/audio.h>
+
+G_BEGIN_DECLS
+
+/* formats the generated samples can be written into */
+#define GST_AV_SYNC_TEST_AUDIO_FORMATS "{ S16LE, S16BE, S24LE, S24BE, S32LE, S32BE, F32LE, F32BE, F64LE, F64BE }"
+
+/* maximum number of channels the samples can be fanned out to */
+#define GST_AV_SYNC_TEST_AUDIO_MAX_CHANNELS (64)
+
+/*
+ * Packs n mono samples of the internal precision (signed 32 bit, full
+ * scale) densely into the sample format a pack function was looked up for.
+ */
+typedef void (*GstAvSyncTestAudioPackFunc) (guint8 * dest, const gint32 * src, guint n);
+
+GstAvSyncTestAudioPackFunc gst_avsynctest_audio_pack_func (GstAudioFormat format);
+
+void gst_avsynctest_audio_fan_out (const GstAudioInfo * info, guint8 * data, guint num_samples, const guint8 * packed, guint channel);
+guint8 *gst_avsynctest_audio_channel_data (const GstAudioInfo * info, guint8 * data, guint num_samples, guint channel);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_AUDIO_FORMAT_H_
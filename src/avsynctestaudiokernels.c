@@ -0,0 +1,374 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include "avsynctestaudiokernels.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define HAVE_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * The sine is evaluated as sin(pi * x) with x in [-1, 1) derived from the
+ * signed phase. x is folded into [-0.5, 0.5] and fed into a taylor
+ * polynomial, which is accurate to ~4e-6 there, way below 16 bit resolution.
+ * The vector kernels perform the very same single precision operations in
+ * the very same order (the library is built without fp-contraction), which
+ * keeps them bit-exact with the scalar reference.
+ */
+#define SIN_PI_C1 ( 3.14159265f)
+#define SIN_PI_C3 (-5.16771278f)
+#define SIN_PI_C5 ( 2.55016404f)
+#define SIN_PI_C7 (-0.59926453f)
+#define SIN_PI_C9 ( 0.08214589f)
+
+#define PHASE_SCALE (1.0f / 2147483648.0f)
+#define TONE_SCALE (GST_AV_SYNC_TEST_TONE_AMPLITUDE * 2147483647.0f)
+
+/* scalar reference */
+
+static inline gint32
+gst_avsynctest_sine_sample (guint32 phase)
+{
+  gfloat x = (gfloat) (gint32) phase * PHASE_SCALE;
+
+  if (x > 0.5f) {
+    x = 1.0f - x;
+  } else if (x < -0.5f) {
+    x = -1.0f - x;
+  }
+
+  gfloat x2 = x * x;
+  gfloat y = x * (SIN_PI_C1 + x2 * (SIN_PI_C3 + x2 * (SIN_PI_C5 + x2 * (SIN_PI_C7 + x2 * SIN_PI_C9))));
+
+  // the amplitude keeps the result well within the 32 bit range
+  return lrintf (y * TONE_SCALE);
+}
+
+static void
+gst_avsynctest_sawtooth_scalar (gint32 * dest, guint n, guint8 counter)
+{
+  for (guint i = 0; i < n; i++) {
+    // fill with sawtooth ramp (multiply gint8 to gint32 by bit-shifting)
+    dest[i] = (gint32) ((guint32) (guint8) (counter + i) << 24);
+  }
+}
+
+static void
+gst_avsynctest_sine_scalar (gint32 * dest, guint n, guint32 phase, guint32 phase_inc)
+{
+  for (guint i = 0; i < n; i++) {
+    dest[i] = gst_avsynctest_sine_sample (phase);
+    phase += phase_inc;
+  }
+}
+
+static const GstAvSyncTestAudioKernels scalar_kernels = {
+  .name = "scalar",
+  .sawtooth = gst_avsynctest_sawtooth_scalar,
+  .sine = gst_avsynctest_sine_scalar,
+};
+
+#ifdef HAVE_X86_KERNELS
+
+/* SSE2 */
+
+__attribute__ ((target ("sse2")))
+static inline __m128
+gst_avsynctest_sin_pi_sse2 (__m128 x)
+{
+  __m128 gt = _mm_cmpgt_ps (x, _mm_set1_ps (0.5f));
+  __m128 lt = _mm_cmplt_ps (x, _mm_set1_ps (-0.5f));
+  __m128 folded_gt = _mm_sub_ps (_mm_set1_ps (1.0f), x);
+  __m128 folded_lt = _mm_sub_ps (_mm_set1_ps (-1.0f), x);
+  x = _mm_or_ps (_mm_andnot_ps (_mm_or_ps (gt, lt), x),
+      _mm_or_ps (_mm_and_ps (gt, folded_gt), _mm_and_ps (lt, folded_lt)));
+
+  __m128 x2 = _mm_mul_ps (x, x);
+  __m128 y = _mm_add_ps (_mm_set1_ps (SIN_PI_C7), _mm_mul_ps (x2, _mm_set1_ps (SIN_PI_C9)));
+  y = _mm_add_ps (_mm_set1_ps (SIN_PI_C5), _mm_mul_ps (x2, y));
+  y = _mm_add_ps (_mm_set1_ps (SIN_PI_C3), _mm_mul_ps (x2, y));
+  y = _mm_add_ps (_mm_set1_ps (SIN_PI_C1), _mm_mul_ps (x2, y));
+  return _mm_mul_ps (x, y);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+gst_avsynctest_sawtooth_sse2 (gint32 * dest, guint n, guint8 counter)
+{
+  __m128i ramp = _mm_add_epi32 (_mm_set1_epi32 (counter), _mm_setr_epi32 (0, 1, 2, 3));
+  __m128i step = _mm_set1_epi32 (4);
+
+  guint i = 0;
+  for (; i + 4 <= n; i += 4) {
+    // shifting the 32 bit lanes drops the bits above the 8 bit counter
+    _mm_storeu_si128 ((__m128i *) (dest + i), _mm_slli_epi32 (ramp, 24));
+    ramp = _mm_add_epi32 (ramp, step);
+  }
+
+  gst_avsynctest_sawtooth_scalar (dest + i, n - i, counter + i);
+}
+
+__attribute__ ((target ("sse2")))
+static void
+gst_avsynctest_sine_sse2 (gint32 * dest, guint n, guint32 phase, guint32 phase_inc)
+{
+  __m128i phases = _mm_setr_epi32 (phase, phase + phase_inc, phase + 2 * phase_inc, phase + 3 * phase_inc);
+  __m128i step = _mm_set1_epi32 (4 * phase_inc);
+  __m128 phase_scale = _mm_set1_ps (PHASE_SCALE);
+  __m128 tone_scale = _mm_set1_ps (TONE_SCALE);
+
+  guint i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128 y = gst_avsynctest_sin_pi_sse2 (_mm_mul_ps (_mm_cvtepi32_ps (phases), phase_scale));
+    phases = _mm_add_epi32 (phases, step);
+
+    _mm_storeu_si128 ((__m128i *) (dest + i), _mm_cvtps_epi32 (_mm_mul_ps (y, tone_scale)));
+  }
+
+  gst_avsynctest_sine_scalar (dest + i, n - i, phase + i * phase_inc, phase_inc);
+}
+
+static const GstAvSyncTestAudioKernels sse2_kernels = {
+  .name = "sse2",
+  .sawtooth = gst_avsynctest_sawtooth_sse2,
+  .sine = gst_avsynctest_sine_sse2,
+};
+
+/* AVX2 */
+
+__attribute__ ((target ("avx2")))
+static inline __m256
+gst_avsynctest_sin_pi_avx2 (__m256 x)
+{
+  __m256 gt = _mm256_cmp_ps (x, _mm256_set1_ps (0.5f), _CMP_GT_OQ);
+  __m256 lt = _mm256_cmp_ps (x, _mm256_set1_ps (-0.5f), _CMP_LT_OQ);
+  x = _mm256_blendv_ps (x, _mm256_sub_ps (_mm256_set1_ps (1.0f), x), gt);
+  x = _mm256_blendv_ps (x, _mm256_sub_ps (_mm256_set1_ps (-1.0f), x), lt);
+
+  __m256 x2 = _mm256_mul_ps (x, x);
+  __m256 y = _mm256_add_ps (_mm256_set1_ps (SIN_PI_C7), _mm256_mul_ps (x2, _mm256_set1_ps (SIN_PI_C9)));
+  y = _mm256_add_ps (_mm256_set1_ps (SIN_PI_C5), _mm256_mul_ps (x2, y));
+  y = _mm256_add_ps (_mm256_set1_ps (SIN_PI_C3), _mm256_mul_ps (x2, y));
+  y = _mm256_add_ps (_mm256_set1_ps (SIN_PI_C1), _mm256_mul_ps (x2, y));
+  return _mm256_mul_ps (x, y);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+gst_avsynctest_sawtooth_avx2 (gint32 * dest, guint n, guint8 counter)
+{
+  __m256i ramp = _mm256_add_epi32 (_mm256_set1_epi32 (counter), _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7));
+  __m256i step = _mm256_set1_epi32 (8);
+
+  guint i = 0;
+  for (; i + 8 <= n; i += 8) {
+    // shifting the 32 bit lanes drops the bits above the 8 bit counter
+    _mm256_storeu_si256 ((__m256i *) (dest + i), _mm256_slli_epi32 (ramp, 24));
+    ramp = _mm256_add_epi32 (ramp, step);
+  }
+
+  gst_avsynctest_sawtooth_scalar (dest + i, n - i, counter + i);
+}
+
+__attribute__ ((target ("avx2")))
+static void
+gst_avsynctest_sine_avx2 (gint32 * dest, guint n, guint32 phase, guint32 phase_inc)
+{
+  __m256i phases = _mm256_add_epi32 (_mm256_set1_epi32 (phase),
+      _mm256_mullo_epi32 (_mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32 (phase_inc)));
+  __m256i step = _mm256_set1_epi32 (8 * phase_inc);
+  __m256 phase_scale = _mm256_set1_ps (PHASE_SCALE);
+  __m256 tone_scale = _mm256_set1_ps (TONE_SCALE);
+
+  guint i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256 y = gst_avsynctest_sin_pi_avx2 (_mm256_mul_ps (_mm256_cvtepi32_ps (phases), phase_scale));
+    phases = _mm256_add_epi32 (phases, step);
+
+    _mm256_storeu_si256 ((__m256i *) (dest + i), _mm256_cvtps_epi32 (_mm256_mul_ps (y, tone_scale)));
+  }
+
+  gst_avsynctest_sine_scalar (dest + i, n - i, phase + i * phase_inc, phase_inc);
+}
+
+static const GstAvSyncTestAudioKernels avx2_kernels = {
+  .name = "avx2",
+  .sawtooth = gst_avsynctest_sawtooth_avx2,
+  .sine = gst_avsynctest_sine_avx2,
+};
+
+#endif // HAVE_X86_KERNELS
+
+#ifdef HAVE_NEON_KERNELS
+
+/* NEON */
+
+static inline float32x4_t
+gst_avsynctest_sin_pi_neon (float32x4_t x)
+{
+  uint32x4_t gt = vcgtq_f32 (x, vdupq_n_f32 (0.5f));
+  uint32x4_t lt = vcltq_f32 (x, vdupq_n_f32 (-0.5f));
+  x = vbslq_f32 (gt, vsubq_f32 (vdupq_n_f32 (1.0f), x), x);
+  x = vbslq_f32 (lt, vsubq_f32 (vdupq_n_f32 (-1.0f), x), x);
+
+  float32x4_t x2 = vmulq_f32 (x, x);
+  float32x4_t y = vaddq_f32 (vdupq_n_f32 (SIN_PI_C7), vmulq_f32 (x2, vdupq_n_f32 (SIN_PI_C9)));
+  y = vaddq_f32 (vdupq_n_f32 (SIN_PI_C5), vmulq_f32 (x2, y));
+  y = vaddq_f32 (vdupq_n_f32 (SIN_PI_C3), vmulq_f32 (x2, y));
+  y = vaddq_f32 (vdupq_n_f32 (SIN_PI_C1), vmulq_f32 (x2, y));
+  return vmulq_f32 (x, y);
+}
+
+static void
+gst_avsynctest_sawtooth_neon (gint32 * dest, guint n, guint8 counter)
+{
+  static const gint32 lanes[4] = { 0, 1, 2, 3 };
+  int32x4_t ramp = vaddq_s32 (vdupq_n_s32 (counter), vld1q_s32 (lanes));
+  int32x4_t step = vdupq_n_s32 (4);
+
+  guint i = 0;
+  for (; i + 4 <= n; i += 4) {
+    // shifting the 32 bit lanes drops the bits above the 8 bit counter
+    vst1q_s32 (dest + i, vshlq_n_s32 (ramp, 24));
+    ramp = vaddq_s32 (ramp, step);
+  }
+
+  gst_avsynctest_sawtooth_scalar (dest + i, n - i, counter + i);
+}
+
+static void
+gst_avsynctest_sine_neon (gint32 * dest, guint n, guint32 phase, guint32 phase_inc)
+{
+  static const guint32 lanes[4] = { 0, 1, 2, 3 };
+  uint32x4_t phases = vmlaq_n_u32 (vdupq_n_u32 (phase), vld1q_u32 (lanes), phase_inc);
+  uint32x4_t step = vdupq_n_u32 (4 * phase_inc);
+  float32x4_t phase_scale = vdupq_n_f32 (PHASE_SCALE);
+  float32x4_t tone_scale = vdupq_n_f32 (TONE_SCALE);
+
+  guint i = 0;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t y = gst_avsynctest_sin_pi_neon (vmulq_f32 (vcvtq_f32_s32 (vreinterpretq_s32_u32 (phases)), phase_scale));
+    phases = vaddq_u32 (phases, step);
+
+    vst1q_s32 (dest + i, vcvtnq_s32_f32 (vmulq_f32 (y, tone_scale)));
+  }
+
+  gst_avsynctest_sine_scalar (dest + i, n - i, phase + i * phase_inc, phase_inc);
+}
+
+static const GstAvSyncTestAudioKernels neon_kernels = {
+  .name = "neon",
+  .sawtooth = gst_avsynctest_sawtooth_neon,
+  .sine = gst_avsynctest_sine_neon,
+};
+
+#endif // HAVE_NEON_KERNELS
+
+const GstAvSyncTestAudioKernels *
+gst_avsynctest_audio_kernels_scalar (void)
+{
+  return &scalar_kernels;
+}
+
+static const GstAvSyncTestAudioKernels *
+gst_avsynctest_audio_kernels_select (void)
+{
+#ifdef HAVE_X86_KERNELS
+  __builtin_cpu_init ();
+
+  if (__builtin_cpu_supports ("avx2")) {
+    return &avx2_kernels;
+  }
+
+  if (__builtin_cpu_supports ("sse2")) {
+    return &sse2_kernels;
+  }
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+  // NEON is mandatory on aarch64
+  return &neon_kernels;
+#endif
+
+  return &scalar_kernels;
+}
+
+/*
+ * The fastest set of kernels supported by the cpu we are running on,
+ * selected once on first use.
+ */
+const GstAvSyncTestAudioKernels *
+gst_avsynctest_audio_kernels_get (void)
+{
+  static gsize kernels = 0;
+
+  if (g_once_init_enter (&kernels)) {
+    g_once_init_leave (&kernels, (gsize) gst_avsynctest_audio_kernels_select ());
+  }
+
+  return (const GstAvSyncTestAudioKernels *) kernels;
+}
+
+/*
+ * Every set of kernels the cpu we are running on supports, the scalar
+ * reference first, NULL-terminated. Used to verify them against each other.
+ */
+const GstAvSyncTestAudioKernels *const *
+gst_avsynctest_audio_kernels_list (void)
+{
+  static const GstAvSyncTestAudioKernels *list[4];
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized)) {
+    guint n = 0;
+    list[n++] = &scalar_kernels;
+
+#ifdef HAVE_X86_KERNELS
+    __builtin_cpu_init ();
+
+    if (__builtin_cpu_supports ("sse2")) {
+      list[n++] = &sse2_kernels;
+    }
+
+    if (__builtin_cpu_supports ("avx2")) {
+      list[n++] = &avx2_kernels;
+    }
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+    list[n++] = &neon_kernels;
+#endif
+
+    list[n] = NULL;
+    g_once_init_leave (&initialized, 1);
+  }
+
+  return list;
+}
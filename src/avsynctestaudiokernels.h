@@ -0,0 +1,56 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_AUDIO_KERNELS_H_
+#define _GST_AV_SYNC_TEST_AUDIO_KERNELS_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* amplitude of the generated tones, relative to full scale */
+#define GST_AV_SYNC_TEST_TONE_AMPLITUDE (0.8f)
+
+/*
+ * Sample generation kernels. All implementations of a kernel produce
+ * bit-exact the same output as the scalar reference implementation.
+ *
+ * The kernels work on mono signed 32 bit samples, full scale being the full
+ * 32 bit range, which is the internal precision of the audio source. They
+ * are converted into the negotiated format in a second step.
+ *
+ * sawtooth: writes n samples of a ramp starting at counter, incrementing
+ *           the 8 bit counter per sample and scaling it to 32 bit.
+ * sine:     writes n samples of a sine-tone, starting at phase and advancing
+ *           the 32 bit phase-accumulator by phase_inc per sample. A full
+ *           period of the tone corresponds to 2^32.
+ */
+typedef struct _GstAvSyncTestAudioKernels
+{
+  const gchar *name;
+
+  void (*sawtooth) (gint32 * dest, guint n, guint8 counter);
+  void (*sine) (gint32 * dest, guint n, guint32 phase, guint32 phase_inc);
+} GstAvSyncTestAudioKernels;
+
+const GstAvSyncTestAudioKernels *gst_avsynctest_audio_kernels_scalar (void);
+const GstAvSyncTestAudioKernels *gst_avsynctest_audio_kernels_get (void);
+const GstAvSyncTestAudioKernels *const *gst_avsynctest_audio_kernels_list (void);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_AUDIO_KERNELS_H_
@@ -21,13 +21,20 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <string.h>
 #include "avsynctestaudiosrc.h"
+#include "avsynctestmeta.h"
+#include "avsynctesttimecode.h"
 
 /* pad templates */
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS("audio/x-raw,format=S16LE")
+    GST_STATIC_CAPS("audio/x-raw,format=" GST_AV_SYNC_TEST_AUDIO_FORMATS ","
+        "layout={ interleaved, non-interleaved },"
+        "rate=[ 1, MAX ],"
+        "channels=[ 1, 64 ]")
 );
 
 GST_DEBUG_CATEGORY_STATIC (gst_avsynctestaudiosrc_debug);
@@ -37,6 +44,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_avsynctestaudiosrc_debug);
 enum
 {
   SIGNAL_SYNC_POINT,
+  SIGNAL_PULL_SYNC_POINT,
   LAST_SIGNAL
 };
 
@@ -47,11 +55,60 @@ static guint gst_av_sync_test_audio_src_signals[LAST_SIGNAL] = { 0, };
 enum
 {
   PROP_0,
+  PROP_WAVE,
   PROP_FREQ,
+  PROP_SAMPLES_PER_BUFFER,
+  PROP_EMIT_SIGNALS,
+  PROP_SYNC_FRAMERATE,
+  PROP_IS_LIVE,
+  PROP_TIMECODE_CHANNEL,
+  PROP_SYNC_INTERVAL,
+  PROP_SYNC_INTERVAL_FRAMES,
+  PROP_SYNC_PATTERN,
 };
 
 /* property defaults */
-#define PROP_FREQ_DEFAULT (0.0)
+#define PROP_WAVE_DEFAULT (GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH)
+#define PROP_FREQ_DEFAULT (1000.0)
+#define PROP_SAMPLES_PER_BUFFER_DEFAULT (1024)
+// the blocksize of the most channels of F64 still fits into a guint
+#define PROP_SAMPLES_PER_BUFFER_MAX ((gint) (G_MAXUINT / (GST_AV_SYNC_TEST_AUDIO_MAX_CHANNELS * sizeof (gdouble))))
+#define PROP_EMIT_SIGNALS_DEFAULT (TRUE)
+#define PROP_SYNC_FRAMERATE_N_DEFAULT (0)
+#define PROP_SYNC_FRAMERATE_D_DEFAULT (1)
+#define PROP_IS_LIVE_DEFAULT (TRUE)
+#define PROP_TIMECODE_CHANNEL_DEFAULT (-1)
+#define PROP_SYNC_INTERVAL_DEFAULT (GST_SECOND)
+#define PROP_SYNC_INTERVAL_FRAMES_DEFAULT (0)
+#define PROP_SYNC_PATTERN_DEFAULT (GST_AV_SYNC_TEST_SYNC_PATTERN_SINGLE)
+
+/* level of the linear timecode, relative to full scale */
+#define LTC_AMPLITUDE (G_MAXINT32 / 2)
+
+/* length of the beep at every sync-point */
+#define SYNC_BEEP_DURATION (GST_SECOND / 25)
+
+/* alignment mask of the wavetable, to the 32 bytes of the widest (avx2) kernels */
+#define WAVETABLE_ALIGN (31)
+
+#define GST_TYPE_AV_SYNC_TEST_AUDIO_SRC_WAVE (gst_avsynctestaudiosrc_wave_get_type ())
+static GType
+gst_avsynctestaudiosrc_wave_get_type (void)
+{
+  static GType wave_type = 0;
+  static const GEnumValue wave_types[] = {
+    {GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SILENCE, "Silence", "silence"},
+    {GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH, "Sawtooth", "sawtooth"},
+    {GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SINE, "Sine", "sine"},
+    {GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SYNC_BEEP, "Sine-Beep at every Sync-Point, Silence otherwise", "sync-beep"},
+    {0, NULL, NULL},
+  };
+
+  if (!wave_type) {
+    wave_type = g_enum_register_static ("GstAvSyncTestAudioSrcWave", wave_types);
+  }
+  return wave_type;
+}
 
 
 /* parent class */
@@ -65,8 +122,18 @@ static void gst_avsynctestaudiosrc_finalize (GObject * obj);
 
 /* GstPushSrc member methods */
 static gboolean gst_avsynctestaudiosrc_set_caps (GstBaseSrc * base, GstCaps * caps);
+static GstCaps *gst_avsynctestaudiosrc_fixate (GstBaseSrc * base, GstCaps * caps);
+static void gst_avsynctestaudiosrc_get_times (GstBaseSrc * base, GstBuffer * buffer, GstClockTime * start, GstClockTime * end);
+static gboolean gst_avsynctestaudiosrc_query (GstBaseSrc * base, GstQuery * query);
+static gboolean gst_avsynctestaudiosrc_is_seekable (GstBaseSrc * base);
+static gboolean gst_avsynctestaudiosrc_do_seek (GstBaseSrc * base, GstSegment * segment);
 static GstFlowReturn gst_avsynctestaudiosrc_fill (GstPushSrc * base, GstBuffer *buffer);
 
+/* GstAvSyncTestAudioSrc member methods */
+static void gst_avsynctestaudiosrc_seek_samples (GstAvSyncTestAudioSrc * avsynctestaudiosrc, GstClockTime position);
+static GstStructure *gst_avsynctestaudiosrc_pull_sync_point (GstAvSyncTestAudioSrc * avsynctestaudiosrc);
+static void gst_avsynctestaudiosrc_free_wavetable (GstAvSyncTestAudioSrc * avsynctestaudiosrc);
+
 static void
 gst_avsynctestaudiosrc_class_init (GstAvSyncTestAudioSrcClass * klass)
 {
@@ -77,13 +144,80 @@ gst_avsynctestaudiosrc_class_init (GstAvSyncTestAudioSrcClass * klass)
   gobject_class->get_property = gst_avsynctestaudiosrc_get_property;
   gobject_class->finalize = gst_avsynctestaudiosrc_finalize;
 
+  g_object_class_install_property (gobject_class, PROP_WAVE,
+      g_param_spec_enum ("wave", "Wave",
+          "Waveform of test signal.",
+          GST_TYPE_AV_SYNC_TEST_AUDIO_SRC_WAVE,
+          PROP_WAVE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE));
+
   g_object_class_install_property (gobject_class, PROP_FREQ,
       g_param_spec_double ("freq", "Freq",
-          "Frequency of test signal.",
-          0.0, 1.0,
+          "Frequency of test signal in Hz. (sine and sync-beep)",
+          1.0, 20000.0,
           PROP_FREQ_DEFAULT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE));
 
+  g_object_class_install_property (gobject_class, PROP_SAMPLES_PER_BUFFER,
+      g_param_spec_int ("samples-per-buffer", "Samples-Per-Buffer",
+          "Number of samples per channel in each outgoing buffer. Also the latency of the source.",
+          1, PROP_SAMPLES_PER_BUFFER_MAX,
+          PROP_SAMPLES_PER_BUFFER_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_EMIT_SIGNALS,
+      g_param_spec_boolean ("emit-signals", "Emit-Signals",
+          "Emit the sync-point Signal on the Streaming-Thread. "
+          "The Sync-Points drained by the pull-sync-point Action-Signal are queued regardless.",
+          PROP_EMIT_SIGNALS_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_FRAMERATE,
+      gst_param_spec_fraction ("sync-framerate", "Sync-Framerate",
+          "Framerate of the Video the Sync-Points are aligned to. Each Sync-Point is moved to the Sample "
+          "matching the PTS of the first Frame at or after its Second. 0/1 places them on whole Seconds.",
+          0, 1, G_MAXINT, 1,
+          PROP_SYNC_FRAMERATE_N_DEFAULT, PROP_SYNC_FRAMERATE_D_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_IS_LIVE,
+      g_param_spec_boolean ("is-live", "Is-Live",
+          "Push Buffers paced by the Clock. When disabled, Buffers are generated as fast as Downstream accepts them.",
+          PROP_IS_LIVE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_TIMECODE_CHANNEL,
+      g_param_spec_int ("timecode-channel", "Timecode-Channel",
+          "Channel carrying an SMPTE LTC of the Video at the sync-framerate instead of the Test-Signal, "
+          "with the Frame-Number in the User-Bits. Silent while no sync-framerate is set. -1 disables it.",
+          -1, 63,
+          PROP_TIMECODE_CHANNEL_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync-Interval",
+          "Time between two Sync-Points in ns. Each is moved to the Sample matching the PTS of the first Frame "
+          "at or after its Time. Has to match the sync-interval of the Video.",
+          GST_MSECOND, 3600 * GST_SECOND,
+          PROP_SYNC_INTERVAL_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL_FRAMES,
+      g_param_spec_uint ("sync-interval-frames", "Sync-Interval-Frames",
+          "Frames at the sync-framerate between two Sync-Points, overrides sync-interval when not 0 "
+          "and a sync-framerate is set.",
+          0, G_MAXINT,
+          PROP_SYNC_INTERVAL_FRAMES_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_PATTERN,
+      g_param_spec_enum ("sync-pattern", "Sync-Pattern",
+          "Beeps sounded at every Sync-Point. The second Beep is aligned to the second Flash of the Video, "
+          "when it fits before the next Sync-Point.",
+          GST_TYPE_AV_SYNC_TEST_SYNC_PATTERN,
+          PROP_SYNC_PATTERN_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
 
   gst_av_sync_test_audio_src_signals[SIGNAL_SYNC_POINT] = g_signal_new (
     /* signal_name */ "sync-point",
@@ -94,12 +228,31 @@ gst_avsynctestaudiosrc_class_init (GstAvSyncTestAudioSrcClass * klass)
     /* accu_data */ NULL,
     /* c_marshaller */ NULL,
     /* return_type */   G_TYPE_NONE,
+    /* n_params */ 3,
+    /* varargs: param types */ G_TYPE_UINT64, G_TYPE_UINT64, G_TYPE_UINT64);
+
+  gst_av_sync_test_audio_src_signals[SIGNAL_PULL_SYNC_POINT] = g_signal_new (
+    /* signal_name */ "pull-sync-point",
+    /* itype */ G_TYPE_FROM_CLASS (klass),
+    /* signal_flags */ G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+    /* class_offset */ G_STRUCT_OFFSET (GstAvSyncTestAudioSrcClass, pull_sync_point),
+    /* accumulator */ NULL,
+    /* accu_data */ NULL,
+    /* c_marshaller */ NULL,
+    /* return_type */   GST_TYPE_STRUCTURE,
     /* n_params */ 0
     /* varargs: param types */);
 
+  klass->pull_sync_point = gst_avsynctestaudiosrc_pull_sync_point;
+
 
   GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS (klass);
   base_src_class->set_caps = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_set_caps);
+  base_src_class->fixate = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_fixate);
+  base_src_class->get_times = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_get_times);
+  base_src_class->query = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_query);
+  base_src_class->is_seekable = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_is_seekable);
+  base_src_class->do_seek = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_do_seek);
 
   GstPushSrcClass *src_class = GST_PUSH_SRC_CLASS (klass);
   src_class->fill = GST_DEBUG_FUNCPTR (gst_avsynctestaudiosrc_fill);
@@ -119,7 +272,37 @@ gst_avsynctestaudiosrc_init (GstAvSyncTestAudioSrc * avsynctestaudiosrc)
 {
   GST_DEBUG_OBJECT (avsynctestaudiosrc, "init");
 
+    avsynctestaudiosrc->wave = PROP_WAVE_DEFAULT;
     avsynctestaudiosrc->freq = PROP_FREQ_DEFAULT;
+    avsynctestaudiosrc->samples_per_buffer = PROP_SAMPLES_PER_BUFFER_DEFAULT;
+    avsynctestaudiosrc->emit_signals = PROP_EMIT_SIGNALS_DEFAULT;
+    avsynctestaudiosrc->sync_fps_n = PROP_SYNC_FRAMERATE_N_DEFAULT;
+    avsynctestaudiosrc->sync_fps_d = PROP_SYNC_FRAMERATE_D_DEFAULT;
+    avsynctestaudiosrc->seek_position = GST_CLOCK_TIME_NONE;
+    avsynctestaudiosrc->timecode_channel = PROP_TIMECODE_CHANNEL_DEFAULT;
+    avsynctestaudiosrc->sync_interval = PROP_SYNC_INTERVAL_DEFAULT;
+    avsynctestaudiosrc->sync_interval_frames = PROP_SYNC_INTERVAL_FRAMES_DEFAULT;
+    avsynctestaudiosrc->sync_pattern = PROP_SYNC_PATTERN_DEFAULT;
+
+    gst_avsynctest_sync_ring_init (&avsynctestaudiosrc->sync_ring);
+
+    avsynctestaudiosrc->kernels = gst_avsynctest_audio_kernels_get ();
+    GST_DEBUG_OBJECT (avsynctestaudiosrc, "using %s kernels", avsynctestaudiosrc->kernels->name);
+
+    // timestamps are derived from the sample position, like the video src does from the frame count
+    gst_base_src_set_format (GST_BASE_SRC (avsynctestaudiosrc), GST_FORMAT_TIME);
+    gst_base_src_set_live (GST_BASE_SRC (avsynctestaudiosrc), PROP_IS_LIVE_DEFAULT);
+}
+
+/* whole frames only, the sample count per buffer is derived from the size */
+static void
+gst_avsynctestaudiosrc_update_blocksize (GstAvSyncTestAudioSrc * src)
+{
+  gint bpf = GST_AUDIO_INFO_BPF (&src->audio_info);
+
+  if (bpf > 0) {
+    gst_base_src_set_blocksize (GST_BASE_SRC (src), (guint) src->samples_per_buffer * bpf);
+  }
 }
 
 void
@@ -128,10 +311,59 @@ gst_avsynctestaudiosrc_set_property (GObject * object, guint property_id, const
   GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (object);
 
   switch (property_id) {
+    case PROP_WAVE:
+      avsynctestaudiosrc->wave = g_value_get_enum(value);
+      break;
+
     case PROP_FREQ:
       avsynctestaudiosrc->freq = g_value_get_double(value);
       break;
 
+    case PROP_SAMPLES_PER_BUFFER:
+      avsynctestaudiosrc->samples_per_buffer = g_value_get_int(value);
+      gst_avsynctestaudiosrc_update_blocksize (avsynctestaudiosrc);
+      gst_element_post_message (GST_ELEMENT (avsynctestaudiosrc),
+          gst_message_new_latency (GST_OBJECT (avsynctestaudiosrc)));
+      break;
+
+    case PROP_EMIT_SIGNALS:
+      avsynctestaudiosrc->emit_signals = g_value_get_boolean(value);
+      break;
+
+    case PROP_SYNC_FRAMERATE:
+      // may be set from the streaming-thread of the video, while fill reads it
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      avsynctestaudiosrc->sync_fps_n = gst_value_get_fraction_numerator (value);
+      avsynctestaudiosrc->sync_fps_d = gst_value_get_fraction_denominator (value);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_IS_LIVE:
+      gst_base_src_set_live (GST_BASE_SRC (avsynctestaudiosrc), g_value_get_boolean(value));
+      break;
+
+    case PROP_TIMECODE_CHANNEL:
+      avsynctestaudiosrc->timecode_channel = g_value_get_int(value);
+      break;
+
+    case PROP_SYNC_INTERVAL:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      avsynctestaudiosrc->sync_interval = g_value_get_uint64(value);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_SYNC_INTERVAL_FRAMES:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      avsynctestaudiosrc->sync_interval_frames = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_SYNC_PATTERN:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      avsynctestaudiosrc->sync_pattern = g_value_get_enum(value);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (avsynctestaudiosrc, property_id, pspec);
@@ -145,10 +377,54 @@ gst_avsynctestaudiosrc_get_property (GObject * object, guint property_id, GValue
   GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (object);
 
   switch (property_id) {
+    case PROP_WAVE:
+      g_value_set_enum (value, avsynctestaudiosrc->wave);
+      break;
+
     case PROP_FREQ:
       g_value_set_double (value, avsynctestaudiosrc->freq);
       break;
 
+    case PROP_SAMPLES_PER_BUFFER:
+      g_value_set_int (value, avsynctestaudiosrc->samples_per_buffer);
+      break;
+
+    case PROP_EMIT_SIGNALS:
+      g_value_set_boolean (value, avsynctestaudiosrc->emit_signals);
+      break;
+
+    case PROP_SYNC_FRAMERATE:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      gst_value_set_fraction (value, avsynctestaudiosrc->sync_fps_n, avsynctestaudiosrc->sync_fps_d);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_IS_LIVE:
+      g_value_set_boolean (value, gst_base_src_is_live (GST_BASE_SRC (avsynctestaudiosrc)));
+      break;
+
+    case PROP_TIMECODE_CHANNEL:
+      g_value_set_int (value, avsynctestaudiosrc->timecode_channel);
+      break;
+
+    case PROP_SYNC_INTERVAL:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      g_value_set_uint64 (value, avsynctestaudiosrc->sync_interval);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_SYNC_INTERVAL_FRAMES:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      g_value_set_uint (value, avsynctestaudiosrc->sync_interval_frames);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
+    case PROP_SYNC_PATTERN:
+      GST_OBJECT_LOCK (avsynctestaudiosrc);
+      g_value_set_enum (value, avsynctestaudiosrc->sync_pattern);
+      GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+      break;
+
 
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (avsynctestaudiosrc, property_id, pspec);
@@ -162,6 +438,10 @@ gst_avsynctestaudiosrc_finalize (GObject * object)
   GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (object);
   GST_DEBUG_OBJECT (avsynctestaudiosrc, "finalize");
 
+  g_free (avsynctestaudiosrc->samples);
+  g_free (avsynctestaudiosrc->packed);
+  gst_avsynctestaudiosrc_free_wavetable (avsynctestaudiosrc);
+  gst_avsynctest_sync_ring_clear (&avsynctestaudiosrc->sync_ring);
 
   G_OBJECT_CLASS (gst_avsynctestaudiosrc_parent_class)->finalize (object);
 }
@@ -172,32 +452,499 @@ gst_avsynctestaudiosrc_set_caps (GstBaseSrc * base, GstCaps * caps)
   GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
   GST_DEBUG_OBJECT (avsynctestaudiosrc, "set_caps caps=%" GST_PTR_FORMAT, caps);
 
-  gst_audio_info_from_caps (&avsynctestaudiosrc->audio_info, caps);
+  if (!gst_audio_info_from_caps (&avsynctestaudiosrc->audio_info, caps)) {
+    GST_ERROR_OBJECT (avsynctestaudiosrc, "invalid caps %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  }
+
+  // the intermediate buffers are sized for the previous format
+  avsynctestaudiosrc->scratch_samples = 0;
+  avsynctestaudiosrc->wavetable_valid = FALSE;
+
+  avsynctestaudiosrc->pack = gst_avsynctest_audio_pack_func (GST_AUDIO_INFO_FORMAT (&avsynctestaudiosrc->audio_info));
+  if (avsynctestaudiosrc->pack == NULL) {
+    GST_ERROR_OBJECT (avsynctestaudiosrc, "unsupported format %s",
+        GST_AUDIO_INFO_NAME (&avsynctestaudiosrc->audio_info));
+    return FALSE;
+  }
+
+  gst_avsynctestaudiosrc_update_blocksize (avsynctestaudiosrc);
+
+  if (GST_CLOCK_TIME_IS_VALID (avsynctestaudiosrc->seek_position)) {
+    gst_avsynctestaudiosrc_seek_samples (avsynctestaudiosrc, avsynctestaudiosrc->seek_position);
+  }
+
+  return TRUE;
+}
+
+static GstCaps *gst_avsynctestaudiosrc_fixate (GstBaseSrc * base, GstCaps * caps)
+{
+  GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
+  GST_DEBUG_OBJECT (avsynctestaudiosrc, "fixate in=%" GST_PTR_FORMAT, caps);
+
+  caps = gst_caps_make_writable (caps);
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+
+  gst_structure_fixate_field_nearest_int (structure, "rate", 48000);
+  gst_structure_fixate_field_nearest_int (structure, "channels", 1);
+  gst_structure_fixate_field_string (structure, "layout", "interleaved");
+
+  // GstAudioInfo requires a channel-mask for more than two channels
+  gint channels;
+  if (gst_structure_get_int (structure, "channels", &channels) && channels > 2 &&
+      !gst_structure_has_field (structure, "channel-mask")) {
+    gst_structure_set (structure, "channel-mask", GST_TYPE_BITMASK,
+        gst_audio_channel_get_fallback_mask (channels), NULL);
+  }
+
+  caps = GST_BASE_SRC_CLASS (parent_class)->fixate (base, caps);
+
+  GST_DEBUG_OBJECT (avsynctestaudiosrc, "fixate out=%" GST_PTR_FORMAT, caps);
+  return caps;
+}
+
+static void
+gst_avsynctestaudiosrc_get_times (GstBaseSrc * base, GstBuffer * buffer, GstClockTime * start, GstClockTime * end)
+{
+  GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
+  GST_DEBUG_OBJECT (avsynctestaudiosrc, "get_times pts=%" GST_TIME_FORMAT " duration=%" GST_TIME_FORMAT,
+    GST_TIME_ARGS(GST_BUFFER_PTS (buffer)),
+    GST_TIME_ARGS(GST_BUFFER_DURATION (buffer)));
+
+  // only a live source waits for the clock, otherwise buffers are pushed as fast as downstream takes them
+  if (!gst_base_src_is_live (base)) {
+    return;
+  }
+
+  GstClockTime timestamp = GST_BUFFER_PTS (buffer);
+
+  if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    /* get duration to calculate end time */
+    GstClockTime duration = GST_BUFFER_DURATION (buffer);
+
+    if (GST_CLOCK_TIME_IS_VALID (duration)) {
+      *end = timestamp + duration;
+    }
+    *start = timestamp;
+  }
+}
+
+static gboolean
+gst_avsynctestaudiosrc_query (GstBaseSrc * base, GstQuery * query)
+{
+  GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    {
+      gint rate = GST_AUDIO_INFO_RATE (&avsynctestaudiosrc->audio_info);
+      if (rate <= 0) {
+        return FALSE;
+      }
+
+      // a buffer can only be pushed once its last sample is due
+      GstClockTime latency = gst_util_uint64_scale_int (avsynctestaudiosrc->samples_per_buffer, GST_SECOND, rate);
+      GST_DEBUG_OBJECT (avsynctestaudiosrc, "latency %" GST_TIME_FORMAT, GST_TIME_ARGS (latency));
+
+      gst_query_set_latency (query, gst_base_src_is_live (base), latency, latency);
+      return TRUE;
+    }
+
+    default:
+      return GST_BASE_SRC_CLASS (parent_class)->query (base, query);
+  }
+}
+
+/*
+ * moves to the sample at or after position, or defers it until the rate is
+ * known. Played backwards, this is the end of the next buffer.
+ */
+static void
+gst_avsynctestaudiosrc_seek_samples (GstAvSyncTestAudioSrc * src, GstClockTime position)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&src->audio_info);
+  if (rate <= 0) {
+    src->n_samples = 0;
+    src->seek_position = position;
+    return;
+  }
+
+  src->n_samples = gst_util_uint64_scale_int_ceil (position, rate, GST_SECOND);
+  src->seek_position = GST_CLOCK_TIME_NONE;
+
+  GST_DEBUG_OBJECT (src, "seeked to sample %" G_GUINT64_FORMAT, src->n_samples);
+}
+
+static gboolean
+gst_avsynctestaudiosrc_is_seekable (GstBaseSrc * base)
+{
+  return TRUE;
+}
+
+static gboolean
+gst_avsynctestaudiosrc_do_seek (GstBaseSrc * base, GstSegment * segment)
+{
+  GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
+  GST_DEBUG_OBJECT (avsynctestaudiosrc, "do_seek segment=%" GST_SEGMENT_FORMAT, segment);
+
+  // backwards from the stop, which is where the segment position of a reverse seek is
+  if (segment->rate < 0.0 && !GST_CLOCK_TIME_IS_VALID (segment->stop)) {
+    GST_WARNING_OBJECT (avsynctestaudiosrc, "reverse playback requires a stop position");
+    return FALSE;
+  }
+
+  segment->time = segment->start;
+  avsynctestaudiosrc->reverse = segment->rate < 0.0;
+  gst_avsynctestaudiosrc_seek_samples (avsynctestaudiosrc, segment->position);
+
+  return TRUE;
+}
+
+static void
+gst_avsynctestaudiosrc_timestamp_buffer (GstAvSyncTestAudioSrc * src, GstBuffer * buffer, guint64 start, guint num_samples)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&src->audio_info);
+  guint64 next_sample = start + num_samples;
+
+  // both ends are scaled from the sample position, so rounding never accumulates
+  GstClockTime pts = gst_util_uint64_scale_int (start, GST_SECOND, rate);
+  GstClockTime next_pts = gst_util_uint64_scale_int (next_sample, GST_SECOND, rate);
+
+  GST_BUFFER_PTS (buffer) = pts;
+  GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DURATION (buffer) = next_pts - pts;
+  GST_BUFFER_OFFSET (buffer) = start;
+  GST_BUFFER_OFFSET_END (buffer) = next_sample;
+}
+
+/* sample of the sync-point k on the timeline of the sync-framerate */
+static guint64
+gst_avsynctestaudiosrc_sync_sample (GstAvSyncTestAudioSrc * src, guint64 k)
+{
+  return gst_avsynctest_timeline_sync_sample (&src->timeline, k, src->audio_info.rate);
+}
+
+/* queues and signals the sync-points within the num_samples from start */
+static gboolean
+gst_avsynctestaudiosrc_sync_points (GstAvSyncTestAudioSrc * src, guint64 start, guint num_samples, guint64 * first_index)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&src->audio_info);
+  guint64 end = start + num_samples;
+
+  guint64 k = gst_avsynctest_timeline_sync_point_at (&src->timeline, start, rate);
+  if (gst_avsynctestaudiosrc_sync_sample (src, k) < start) {
+    k++;
+  }
+
+  *first_index = gst_avsynctestaudiosrc_sync_sample (src, k);
+  gboolean found = *first_index < end;
+
+  for (guint64 index; (index = gst_avsynctestaudiosrc_sync_sample (src, k)) < end; k++) {
+    GstClockTime pts = gst_util_uint64_scale_int (index, GST_SECOND, rate);
+    GstAvSyncTestSyncEvent event = {
+      .pts = pts,
+      .running_time = gst_segment_to_running_time (&GST_BASE_SRC (src)->segment, GST_FORMAT_TIME, pts),
+      .index = index,
+    };
+
+    if (!gst_avsynctest_sync_ring_push (&src->sync_ring, &event)) {
+      GST_LOG_OBJECT (src, "sync-point ring full, dropped sync-point of sample %" G_GUINT64_FORMAT, index);
+    }
+
+    if (src->emit_signals) {
+      g_signal_emit (src, gst_av_sync_test_audio_src_signals[SIGNAL_SYNC_POINT], 0,
+          event.pts, event.running_time, event.index);
+    }
+  }
+
+  return found;
+}
+
+static GstStructure *
+gst_avsynctestaudiosrc_pull_sync_point (GstAvSyncTestAudioSrc * avsynctestaudiosrc)
+{
+  return gst_avsynctest_sync_ring_pull (&avsynctestaudiosrc->sync_ring);
+}
+
+/* advance of the 32 bit phase-accumulator per sample for the configured freq */
+static guint32
+gst_avsynctestaudiosrc_phase_inc (GstAvSyncTestAudioSrc * src)
+{
+  return (guint32) (guint64) llround (src->freq / src->audio_info.rate * 4294967296.0);
+}
+
+/* grow the intermediate sample buffers to hold at least num_samples */
+static void
+gst_avsynctestaudiosrc_ensure_scratch (GstAvSyncTestAudioSrc * src, guint num_samples)
+{
+  if (num_samples <= src->scratch_samples) {
+    return;
+  }
+
+  src->samples = g_renew (gint32, src->samples, num_samples);
+  src->packed = g_renew (guint8, src->packed, (gsize) num_samples * GST_AUDIO_INFO_BPS (&src->audio_info));
+  src->scratch_samples = num_samples;
+}
+
+static void
+gst_avsynctestaudiosrc_free_wavetable (GstAvSyncTestAudioSrc * src)
+{
+  if (src->wavetable_memory != NULL) {
+    gst_memory_unmap (src->wavetable_memory, &src->wavetable_map);
+    gst_memory_unref (src->wavetable_memory);
+    src->wavetable_memory = NULL;
+    src->wavetable = NULL;
+  }
+}
+
+/*
+ * Packs the periodic part of the wave into the wavetable, once per caps,
+ * wave and freq. Returns FALSE for waves that are not generated from it.
+ */
+static gboolean
+gst_avsynctestaudiosrc_ensure_wavetable (GstAvSyncTestAudioSrc * src)
+{
+  if (src->wave != GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH && src->wave != GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SYNC_BEEP) {
+    return FALSE;
+  }
+
+  if (src->wavetable_valid && src->wavetable_wave == src->wave && src->wavetable_freq == src->freq) {
+    return TRUE;
+  }
 
+  guint num_samples;
+  if (src->wave == GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH) {
+    // the 8 bit counter wraps around every 256 samples
+    num_samples = 256;
+  } else {
+    num_samples = gst_util_uint64_scale (SYNC_BEEP_DURATION, src->audio_info.rate, GST_SECOND);
+  }
+
+  gint32 *samples = g_new (gint32, MAX (num_samples, 1));
+  if (src->wave == GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH) {
+    src->kernels->sawtooth (samples, num_samples, 0);
+  } else {
+    src->kernels->sine (samples, num_samples, 0, gst_avsynctestaudiosrc_phase_inc (src));
+  }
+
+  // copies from the start of a period load from a vector boundary
+  GstAllocationParams params;
+  gst_allocation_params_init (&params);
+  params.align = WAVETABLE_ALIGN;
+
+  gst_avsynctestaudiosrc_free_wavetable (src);
+  src->wavetable_memory = gst_allocator_alloc (NULL, (gsize) MAX (num_samples, 1) * GST_AUDIO_INFO_BPS (&src->audio_info), &params);
+  gst_memory_map (src->wavetable_memory, &src->wavetable_map, GST_MAP_READWRITE);
+  src->wavetable = src->wavetable_map.data;
+  src->pack (src->wavetable, samples, num_samples);
+  g_free (samples);
+
+  src->wavetable_samples = num_samples;
+  src->wavetable_wave = src->wave;
+  src->wavetable_freq = src->freq;
+  src->wavetable_valid = TRUE;
+
+  GST_DEBUG_OBJECT (src, "packed a wavetable of %u samples", num_samples);
   return TRUE;
 }
 
+/*
+ * Generates the num_samples from start, only depending on their position,
+ * packed into the format. The periodic waves are copied from the wavetable,
+ * the sine is computed sample by sample.
+ */
+static void
+gst_avsynctestaudiosrc_generate (GstAvSyncTestAudioSrc * src, guint8 * packed, guint64 start, guint num_samples)
+{
+  gsize bps = GST_AUDIO_INFO_BPS (&src->audio_info);
+
+  if (src->wave == GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SILENCE) {
+    // all supported formats are signed or float, so silence is all zero
+    memset (packed, 0, num_samples * bps);
+    return;
+  }
+
+  if (!gst_avsynctestaudiosrc_ensure_wavetable (src)) {
+    // the phase wraps around, so the product needs no more than 32 bits
+    guint32 phase_inc = gst_avsynctestaudiosrc_phase_inc (src);
+    src->kernels->sine (src->samples, num_samples, (guint32) start * phase_inc, phase_inc);
+    src->pack (packed, src->samples, num_samples);
+    return;
+  }
+
+  if (src->wave == GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH) {
+    // wrap-around copy of the period
+    guint done = 0;
+    while (done < num_samples) {
+      guint position = (start + done) % src->wavetable_samples;
+      guint n = MIN (src->wavetable_samples - position, num_samples - done);
+
+      memcpy (packed + done * bps, src->wavetable + position * bps, n * bps);
+      done += n;
+    }
+    return;
+  }
+
+  // split the buffer into beep- and silence-runs, each marker runs until the next one
+  gint rate = src->audio_info.rate;
+  guint64 beep_length = src->wavetable_samples;
+  guint done = 0;
+  while (done < num_samples) {
+    guint64 sample = start + done;
+    guint64 k = gst_avsynctest_timeline_sync_point_at (&src->timeline, sample, rate);
+    guint64 marker = gst_avsynctestaudiosrc_sync_sample (src, k);
+    guint64 next = gst_avsynctestaudiosrc_sync_sample (src, k + 1);
+
+    if (gst_avsynctest_timeline_has_second_marker (&src->timeline, k)) {
+      guint64 second = gst_avsynctest_timeline_second_sample (&src->timeline, k, rate);
+      if (sample < second) {
+        next = second;
+      } else {
+        marker = second;
+      }
+    }
+
+    guint64 position = sample - marker;
+    guint n;
+
+    if (position < beep_length) {
+      // the tone restarts with every beep
+      n = MIN (MIN (beep_length - position, next - sample), num_samples - done);
+      memcpy (packed + done * bps, src->wavetable + position * bps, n * bps);
+    } else {
+      n = MIN (next - sample, num_samples - done);
+      memset (packed + done * bps, 0, n * bps);
+    }
+
+    done += n;
+  }
+}
+
+/*
+ * Generates the linear timecode of the video at the sync-framerate for the
+ * num_samples from start. The half-bits are placed on the sample-timeline
+ * by position, so the LTC-frames stay locked to the video-frames for
+ * any ratio of rate and framerate.
+ */
+static void
+gst_avsynctestaudiosrc_generate_timecode (GstAvSyncTestAudioSrc * src, gint32 * samples, guint64 start, guint num_samples)
+{
+  if (src->timeline.fps_n <= 0) {
+    memset (samples, 0, num_samples * sizeof (gint32));
+    return;
+  }
+
+  guint frames_per_code = gst_avsynctest_ltc_frames_per_code (src->timeline.fps_n, src->timeline.fps_d);
+  guint64 half_bits = (guint64) GST_AV_SYNC_TEST_LTC_HALF_BITS * src->timeline.fps_n;
+  guint64 samples_per = (guint64) src->timeline.fps_d * frames_per_code * src->audio_info.rate;
+
+  guint done = 0;
+  while (done < num_samples) {
+    guint64 sample = start + done;
+    guint64 half_bit = gst_util_uint64_scale (sample, half_bits, samples_per);
+    guint64 next = gst_util_uint64_scale_ceil (half_bit + 1, samples_per, half_bits);
+    guint64 code = half_bit / GST_AV_SYNC_TEST_LTC_HALF_BITS;
+
+    if (code != src->ltc_code || src->timeline.fps_n != src->ltc_fps_n || src->timeline.fps_d != src->ltc_fps_d) {
+      gst_avsynctest_ltc_encode (code, src->timeline.fps_n, src->timeline.fps_d, (guint32) (code * frames_per_code), src->ltc_levels);
+      src->ltc_code = code;
+      src->ltc_fps_n = src->timeline.fps_n;
+      src->ltc_fps_d = src->timeline.fps_d;
+    }
+
+    gint32 level = src->ltc_levels[half_bit % GST_AV_SYNC_TEST_LTC_HALF_BITS] ? LTC_AMPLITUDE : -LTC_AMPLITUDE;
+    guint n = MIN (next - sample, num_samples - done);
+
+    for (guint i = 0; i < n; i++) {
+      samples[done + i] = level;
+    }
+
+    done += n;
+  }
+}
+
 static GstFlowReturn
 gst_avsynctestaudiosrc_fill (GstPushSrc * base, GstBuffer *buffer)
 {
   GstAvSyncTestAudioSrc *avsynctestaudiosrc = GST_AV_SYNC_TEST_AUDIO_SRC (base);
   GST_DEBUG_OBJECT (avsynctestaudiosrc, "fill");
 
+  GstAudioInfo *info = &avsynctestaudiosrc->audio_info;
+  guint channels = GST_AUDIO_INFO_CHANNELS (info);
+
+  guint num_samples = gst_buffer_get_size (buffer) / GST_AUDIO_INFO_BPF (info);
+  guint64 start = avsynctestaudiosrc->n_samples;
+
+  if (avsynctestaudiosrc->reverse) {
+    // played backwards buffer by buffer, the samples within each stay in order
+    if (start == 0) {
+      GST_DEBUG_OBJECT (avsynctestaudiosrc, "eos: reverse playback reached sample 0");
+      return GST_FLOW_EOS;
+    }
+
+    if (num_samples > start) {
+      num_samples = start;
+      gst_buffer_set_size (buffer, (gsize) num_samples * GST_AUDIO_INFO_BPF (info));
+    }
+
+    start -= num_samples;
+  }
+
   GstMapInfo map;
-  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  if (!gst_buffer_map (buffer, &map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (avsynctestaudiosrc, "failed to map buffer");
+    return GST_FLOW_ERROR;
+  }
+
+  // the timeline of this buffer is fixed, even if the sync-framerate changes meanwhile
+  GST_OBJECT_LOCK (avsynctestaudiosrc);
+  gst_avsynctest_timeline_init (&avsynctestaudiosrc->timeline,
+    avsynctestaudiosrc->sync_fps_n, avsynctestaudiosrc->sync_fps_d,
+    avsynctestaudiosrc->sync_interval, avsynctestaudiosrc->sync_interval_frames, avsynctestaudiosrc->sync_pattern);
+  GST_OBJECT_UNLOCK (avsynctestaudiosrc);
+
+  gst_avsynctestaudiosrc_ensure_scratch (avsynctestaudiosrc, num_samples);
+  gst_avsynctestaudiosrc_timestamp_buffer (avsynctestaudiosrc, buffer, start, num_samples);
+  guint64 sync_index;
+  gboolean sync_point = gst_avsynctestaudiosrc_sync_points (avsynctestaudiosrc, start, num_samples, &sync_index);
+  gst_buffer_add_avsynctest_meta (buffer, start, sync_point, sync_index);
+  gst_avsynctest_buffer_add_reference_timestamp (GST_ELEMENT (avsynctestaudiosrc), buffer);
+
+  // a planar or mono buffer has a dense first channel to pack into directly
+  guint8 *packed = avsynctestaudiosrc->packed;
+  if (channels == 1 || GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    packed = gst_avsynctest_audio_channel_data (info, map.data, num_samples, 0);
+  }
 
-  // assuming S16LE / 1 Channel
-  guint num_samples = map.size / sizeof(gint16);
-  for(guint sample_idx = 0; sample_idx < num_samples; sample_idx++) {
-    // pointer to sample
-    gint16 *sample_ptr = ((gint16*) map.data) + sample_idx;
+  // the signal is generated once in mono and then copied into every channel
+  gst_avsynctestaudiosrc_generate (avsynctestaudiosrc, packed, start, num_samples);
+  avsynctestaudiosrc->n_samples = avsynctestaudiosrc->reverse ? start : start + num_samples;
 
-    // fill with sawtooth ramp (multiply gint8 to gint16 by bit-shifting)
-    *sample_ptr = (avsynctestaudiosrc->counter << 8);
-    avsynctestaudiosrc->counter++;
+  gint timecode_channel = avsynctestaudiosrc->timecode_channel;
+  for (guint channel = 0; channel < channels; channel++) {
+    if ((gint) channel != timecode_channel) {
+      gst_avsynctest_audio_fan_out (info, map.data, num_samples, packed, channel);
+    }
+  }
+
+  // the scratch-buffers are free again, the timecode reuses them
+  if (timecode_channel >= 0 && timecode_channel < (gint) channels) {
+    gst_avsynctestaudiosrc_generate_timecode (avsynctestaudiosrc, avsynctestaudiosrc->samples, start, num_samples);
+
+    packed = avsynctestaudiosrc->packed;
+    if (channels == 1 || GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+      packed = gst_avsynctest_audio_channel_data (info, map.data, num_samples, timecode_channel);
+    }
+
+    avsynctestaudiosrc->pack (packed, avsynctestaudiosrc->samples, num_samples);
+    gst_avsynctest_audio_fan_out (info, map.data, num_samples, packed, timecode_channel);
   }
 
   gst_buffer_unmap (buffer, &map);
 
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    gst_buffer_add_audio_meta (buffer, info, num_samples, NULL);
+  }
+
   return GST_FLOW_OK;
 }
@@ -22,6 +22,12 @@
 #include <gst/base/gstpushsrc.h>
   #include <gst/audio/audio.h>
 
+#include "avsynctestaudiokernels.h"
+#include "avsynctestaudioformat.h"
+#include "avsynctestsyncring.h"
+#include "avsynctesttimecode.h"
+#include "avsynctesttimeline.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_AV_SYNC_TEST_AUDIO_SRC           (gst_avsynctestaudiosrc_get_type())
 #define GST_AV_SYNC_TEST_AUDIO_SRC(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_AV_SYNC_TEST_AUDIO_SRC, GstAvSyncTestAudioSrc))
@@ -31,21 +37,77 @@ G_BEGIN_DECLS
 typedef struct _GstAvSyncTestAudioSrc GstAvSyncTestAudioSrc;
 typedef struct _GstAvSyncTestAudioSrcClass GstAvSyncTestAudioSrcClass;
 
+typedef enum
+{
+  GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SILENCE,
+  GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SAWTOOTH,
+  GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SINE,
+  GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SYNC_BEEP,
+} GstAvSyncTestAudioSrcWave;
+
 
 struct _GstAvSyncTestAudioSrc
 {
   GstPushSrc base_avsynctestaudiosrc;
   GstAudioInfo audio_info;
-  gint8 counter;
+  // position of the next sample to generate, all timestamps and samples derive from it
+  guint64 n_samples;
+  // played backwards, n_samples is the end of the next buffer
+  gboolean reverse;
+  // time seeked to before the rate was known, applied to n_samples by set_caps
+  GstClockTime seek_position;
 
+  GstAvSyncTestAudioSrcWave wave;
   gdouble freq;
+  gint samples_per_buffer;
+
+  /* framerate of the video the sync-points align to, and their cadence, protected by the object lock */
+  gint sync_fps_n, sync_fps_d;
+  GstClockTime sync_interval;
+  guint sync_interval_frames;
+  GstAvSyncTestSyncPattern sync_pattern;
+  // the timeline in effect for the buffer being filled
+  GstAvSyncTestTimeline timeline;
+
+  const GstAvSyncTestAudioKernels *kernels;
+  GstAvSyncTestAudioPackFunc pack;
+
+  // mono samples in the internal precision and packed into the format
+  gint32 *samples;
+  guint8 *packed;
+  guint scratch_samples;
+
+  // one period of the sawtooth or the burst of a sync-beep, packed into the format,
+  // in memory aligned to the widest vector width and mapped for as long as it is kept
+  GstMemory *wavetable_memory;
+  GstMapInfo wavetable_map;
+  guint8 *wavetable;
+  guint wavetable_samples;
+  // wave and freq the wavetable was generated for, new caps invalidate it
+  gboolean wavetable_valid;
+  GstAvSyncTestAudioSrcWave wavetable_wave;
+  gdouble wavetable_freq;
+
+  /* channel carrying the linear timecode, -1 for none */
+  gint timecode_channel;
+  // levels of the last encoded LTC-frame, and the framerate it was encoded for
+  guint64 ltc_code;
+  gint ltc_fps_n, ltc_fps_d;
+  guint8 ltc_levels[GST_AV_SYNC_TEST_LTC_HALF_BITS];
+
+  /* sync-points queued for consumers draining them from another thread */
+  GstAvSyncTestSyncRing sync_ring;
+  gboolean emit_signals;
 };
 
 struct _GstAvSyncTestAudioSrcClass
 {
   GstPushSrcClass base_avsynctestaudiosrc_class;
 
-  void (*sync_point) (GstElement * element);
+  void (*sync_point) (GstElement * element, GstClockTime pts, GstClockTime running_time, guint64 sample);
+
+  /* actions */
+  GstStructure *(*pull_sync_point) (GstAvSyncTestAudioSrc * avsynctestaudiosrc);
 };
 
 GType gst_avsynctestaudiosrc_get_type (void);
@@ -0,0 +1,219 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/app/app.h>
+#include "avsynctestencoder.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_avsynctestencoder_debug);
+#define GST_CAT_DEFAULT gst_avsynctestencoder_debug
+
+/* how long to wait for an encoded frame before looking for an error on the bus */
+#define PULL_TIMEOUT (GST_SECOND / 10)
+
+/* encoders tried in order for every compressed format */
+static const struct
+{
+  const gchar *media_type;
+  gboolean intra_only;
+  const gchar *factories[3];
+} encoders[] = {
+  {"image/jpeg", TRUE, {"jpegenc", NULL}},
+  {"video/x-h264", FALSE, {"x264enc", "openh264enc", NULL}},
+  {"video/x-h265", FALSE, {"x265enc", NULL}},
+};
+
+static gint
+gst_avsynctest_encoder_index (const gchar * media_type)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (encoders); i++) {
+    if (g_str_equal (encoders[i].media_type, media_type)) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static GstElementFactory *
+gst_avsynctest_encoder_find (const gchar * media_type)
+{
+  gint index = gst_avsynctest_encoder_index (media_type);
+  if (index < 0) {
+    return NULL;
+  }
+
+  for (const gchar * const *name = encoders[index].factories; *name != NULL; name++) {
+    GstElementFactory *factory = gst_element_factory_find (*name);
+    if (factory != NULL) {
+      return factory;
+    }
+  }
+
+  return NULL;
+}
+
+gboolean
+gst_avsynctest_encoder_available (const gchar * media_type)
+{
+  GstElementFactory *factory = gst_avsynctest_encoder_find (media_type);
+  if (factory == NULL) {
+    return FALSE;
+  }
+
+  gst_object_unref (factory);
+  return TRUE;
+}
+
+/* intra-only formats only need every distinct frame encoded once */
+gboolean
+gst_avsynctest_encoder_is_intra_only (const gchar * media_type)
+{
+  gint index = gst_avsynctest_encoder_index (media_type);
+  return index >= 0 && encoders[index].intra_only;
+}
+
+static void
+gst_avsynctest_encoder_set_if_exists (GstElement * element, const gchar * name, const gchar * value)
+{
+  if (g_object_class_find_property (G_OBJECT_GET_CLASS (element), name) != NULL) {
+    gst_util_set_object_arg (G_OBJECT (element), name, value);
+  }
+}
+
+/*
+ * Configure the encoder to start the loop with a keyframe and to not
+ * reorder frames, so that the encoded loop can be replayed back-to-back.
+ */
+static void
+gst_avsynctest_encoder_configure (GstElement * encoder, guint n_frames)
+{
+  gchar *gop_size = g_strdup_printf ("%u", n_frames);
+
+  gst_avsynctest_encoder_set_if_exists (encoder, "key-int-max", gop_size);
+  gst_avsynctest_encoder_set_if_exists (encoder, "gop-size", gop_size);
+  gst_avsynctest_encoder_set_if_exists (encoder, "bframes", "0");
+  gst_avsynctest_encoder_set_if_exists (encoder, "tune", "zerolatency");
+
+  g_free (gop_size);
+}
+
+/*
+ * Encode frames, raw buffers described by info, into caps once and return
+ * the encoded buffers in the same order, or NULL when encoding failed.
+ */
+GPtrArray *
+gst_avsynctest_encode_loop (GstObject * parent, const GstVideoInfo * info, GstCaps * caps, GPtrArray * frames)
+{
+  GST_DEBUG_CATEGORY_INIT (gst_avsynctestencoder_debug, "avsynctestencoder", 0, "AV Sync-Test Encoder");
+
+  const gchar *media_type = gst_structure_get_name (gst_caps_get_structure (caps, 0));
+  GstElementFactory *factory = gst_avsynctest_encoder_find (media_type);
+  if (factory == NULL) {
+    GST_ERROR_OBJECT (parent, "no encoder for %s installed", media_type);
+    return NULL;
+  }
+
+  GstElement *pipeline = gst_pipeline_new (NULL);
+  GstElement *appsrc = gst_element_factory_make ("appsrc", NULL);
+  GstElement *encoder = gst_element_factory_create (factory, NULL);
+  GstElement *appsink = gst_element_factory_make ("appsink", NULL);
+  gst_object_unref (factory);
+
+  GST_DEBUG_OBJECT (parent, "encoding %u frames with %s", frames->len, GST_ELEMENT_NAME (encoder));
+
+  GstCaps *raw_caps = gst_video_info_to_caps (info);
+  g_object_set (appsrc, "caps", raw_caps, "format", GST_FORMAT_TIME, NULL);
+  g_object_set (appsink, "caps", caps, "sync", FALSE, NULL);
+  gst_caps_unref (raw_caps);
+
+  gst_avsynctest_encoder_configure (encoder, frames->len);
+
+  gst_bin_add_many (GST_BIN (pipeline), appsrc, encoder, appsink, NULL);
+
+  GPtrArray *encoded = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  if (!gst_element_link_many (appsrc, encoder, appsink, NULL)) {
+    GST_ERROR_OBJECT (parent, "could not link %s to %" GST_PTR_FORMAT, GST_ELEMENT_NAME (encoder), caps);
+    goto error;
+  }
+
+  if (gst_element_set_state (pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+    GST_ERROR_OBJECT (parent, "could not start %s", GST_ELEMENT_NAME (encoder));
+    goto error;
+  }
+
+  GstClockTime duration = info->fps_n > 0 ?
+      gst_util_uint64_scale (GST_SECOND, info->fps_d, info->fps_n) : GST_SECOND;
+
+  for (guint i = 0; i < frames->len; i++) {
+    // shares the memory of the frame, the encoder only reads it
+    GstBuffer *buffer = gst_buffer_copy (g_ptr_array_index (frames, i));
+    GST_BUFFER_PTS (buffer) = i * duration;
+    GST_BUFFER_DURATION (buffer) = duration;
+    gst_app_src_push_buffer (GST_APP_SRC (appsrc), buffer);
+  }
+  gst_app_src_end_of_stream (GST_APP_SRC (appsrc));
+
+  // a failing encoder posts an error and never sends eos, so the bus is checked between the pulls
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *message = NULL;
+  while (message == NULL && !gst_app_sink_is_eos (GST_APP_SINK (appsink))) {
+    GstSample *sample = gst_app_sink_try_pull_sample (GST_APP_SINK (appsink), PULL_TIMEOUT);
+    if (sample != NULL) {
+      g_ptr_array_add (encoded, gst_buffer_ref (gst_sample_get_buffer (sample)));
+      gst_sample_unref (sample);
+      continue;
+    }
+
+    message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  }
+
+  if (message == NULL) {
+    message = gst_bus_pop_filtered (bus, GST_MESSAGE_ERROR);
+  }
+  gst_object_unref (bus);
+
+  if (message != NULL) {
+    GError *error = NULL;
+    gst_message_parse_error (message, &error, NULL);
+    GST_ERROR_OBJECT (parent, "%s failed: %s", GST_ELEMENT_NAME (encoder), error->message);
+    g_clear_error (&error);
+    gst_message_unref (message);
+    goto error;
+  }
+
+  if (encoded->len != frames->len) {
+    GST_ERROR_OBJECT (parent, "%s returned %u of %u frames", GST_ELEMENT_NAME (encoder), encoded->len, frames->len);
+    goto error;
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  return encoded;
+
+error:
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_ptr_array_unref (encoded);
+  return NULL;
+}
@@ -0,0 +1,44 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_ENCODER_H_
+#define _GST_AV_SYNC_TEST_ENCODER_H_
+
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+/* compressed formats the test-card can be output in, when an encoder is installed */
+#define GST_AV_SYNC_TEST_ENCODED_CAPS \
+  "image/jpeg, width=" GST_VIDEO_SIZE_RANGE ", height=" GST_VIDEO_SIZE_RANGE ", " \
+    "framerate=" GST_VIDEO_FPS_RANGE ", pixel-aspect-ratio=1/1; " \
+  "video/x-h264, stream-format=byte-stream, alignment=au, width=" GST_VIDEO_SIZE_RANGE ", " \
+    "height=" GST_VIDEO_SIZE_RANGE ", framerate=" GST_VIDEO_FPS_RANGE ", pixel-aspect-ratio=1/1; " \
+  "video/x-h265, stream-format=byte-stream, alignment=au, width=" GST_VIDEO_SIZE_RANGE ", " \
+    "height=" GST_VIDEO_SIZE_RANGE ", framerate=" GST_VIDEO_FPS_RANGE ", pixel-aspect-ratio=1/1"
+
+/* raw format the frames are handed to the encoders in */
+#define GST_AV_SYNC_TEST_ENCODER_INPUT_FORMAT (GST_VIDEO_FORMAT_I420)
+
+gboolean gst_avsynctest_encoder_available (const gchar * media_type);
+gboolean gst_avsynctest_encoder_is_intra_only (const gchar * media_type);
+
+GPtrArray *gst_avsynctest_encode_loop (GstObject * parent, const GstVideoInfo * info, GstCaps * caps, GPtrArray * frames);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_ENCODER_H_
@@ -0,0 +1,97 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctestframepool.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_avsynctestframepool_debug);
+#define GST_CAT_DEFAULT gst_avsynctestframepool_debug
+
+/* parent class */
+#define gst_avsynctestframepool_parent_class parent_class
+G_DEFINE_TYPE (GstAvSyncTestFramePool, gst_avsynctestframepool, GST_TYPE_BUFFER_POOL);
+
+/* GstBufferPool member methods */
+static GstFlowReturn gst_avsynctestframepool_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer, GstBufferPoolAcquireParams * params);
+static void gst_avsynctestframepool_reset_buffer (GstBufferPool * pool, GstBuffer * buffer);
+
+static void
+gst_avsynctestframepool_class_init (GstAvSyncTestFramePoolClass * klass)
+{
+  GstBufferPoolClass *pool_class = GST_BUFFER_POOL_CLASS (klass);
+  pool_class->alloc_buffer = GST_DEBUG_FUNCPTR (gst_avsynctestframepool_alloc_buffer);
+  pool_class->reset_buffer = GST_DEBUG_FUNCPTR (gst_avsynctestframepool_reset_buffer);
+
+  GST_DEBUG_CATEGORY_INIT (gst_avsynctestframepool_debug, "avsynctestframepool", 0, "AV Sync-Test Frame Pool");
+}
+
+static void
+gst_avsynctestframepool_init (GstAvSyncTestFramePool * avsynctestframepool)
+{
+}
+
+GstBufferPool *
+gst_avsynctestframepool_new (void)
+{
+  return g_object_new (GST_TYPE_AV_SYNC_TEST_FRAME_POOL, NULL);
+}
+
+static GstFlowReturn
+gst_avsynctestframepool_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer, GstBufferPoolAcquireParams * params)
+{
+  // the buffers carry no memory of their own, see gst_avsynctestframepool_acquire_frame
+  GST_DEBUG_OBJECT (pool, "allocating empty buffer");
+  *buffer = gst_buffer_new ();
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_avsynctestframepool_reset_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GST_BUFFER_POOL_CLASS (parent_class)->reset_buffer (pool, buffer);
+
+  // drop the reference to the frame memory so the buffer can be recycled
+  gst_buffer_remove_all_memory (buffer);
+  GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+}
+
+/*
+ * Acquire a Buffer from the Pool sharing the Memory of frame. The Memory of
+ * frame is expected to be flagged GST_MEMORY_FLAG_READONLY, so downstream
+ * elements trying to write into the Buffer get a private copy instead.
+ */
+GstFlowReturn
+gst_avsynctestframepool_acquire_frame (GstBufferPool * pool, GstBuffer * frame, GstBuffer ** buffer)
+{
+  GstFlowReturn ret = gst_buffer_pool_acquire_buffer (pool, buffer, NULL);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    return ret;
+  }
+
+  guint n_memory = gst_buffer_n_memory (frame);
+  for (guint memory_idx = 0; memory_idx < n_memory; memory_idx++) {
+    gst_buffer_append_memory (*buffer, gst_buffer_get_memory (frame, memory_idx));
+  }
+
+  return GST_FLOW_OK;
+}
@@ -0,0 +1,55 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_FRAME_POOL_H_
+#define _GST_AV_SYNC_TEST_FRAME_POOL_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_AV_SYNC_TEST_FRAME_POOL           (gst_avsynctestframepool_get_type())
+#define GST_AV_SYNC_TEST_FRAME_POOL(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_AV_SYNC_TEST_FRAME_POOL, GstAvSyncTestFramePool))
+#define GST_AV_SYNC_TEST_FRAME_POOL_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),  GST_TYPE_AV_SYNC_TEST_FRAME_POOL, GstAvSyncTestFramePoolClass))
+#define GST_IS_AV_SYNC_TEST_FRAME_POOL(obj)        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_AV_SYNC_TEST_FRAME_POOL))
+#define GST_IS_AV_SYNC_TEST_FRAME_POOL_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE((klass),  GST_TYPE_AV_SYNC_TEST_FRAME_POOL))
+typedef struct _GstAvSyncTestFramePool GstAvSyncTestFramePool;
+typedef struct _GstAvSyncTestFramePoolClass GstAvSyncTestFramePoolClass;
+
+/*
+ * A Buffer-Pool handing out Buffers that do not own any Memory. Instead
+ * the Memory of a pre-rendered Frame is attached when the Buffer is
+ * acquired and detached again when it returns to the Pool, so that
+ * recycling a Buffer neither allocates nor copies any Pixels.
+ */
+struct _GstAvSyncTestFramePool
+{
+  GstBufferPool base_avsynctestframepool;
+};
+
+struct _GstAvSyncTestFramePoolClass
+{
+  GstBufferPoolClass base_avsynctestframepool_class;
+};
+
+GType gst_avsynctestframepool_get_type (void);
+
+GstBufferPool *gst_avsynctestframepool_new (void);
+GstFlowReturn gst_avsynctestframepool_acquire_frame (GstBufferPool * pool, GstBuffer * frame, GstBuffer ** buffer);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_FRAME_POOL_H_
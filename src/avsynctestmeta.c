@@ -0,0 +1,120 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctestmeta.h"
+
+static GstStaticCaps reference_caps = GST_STATIC_CAPS (GST_AV_SYNC_TEST_REFERENCE_CAPS);
+
+GType
+gst_avsynctest_meta_api_get_type (void)
+{
+  static GType type = 0;
+  // no tags, the position on the timeline survives any transformation of the content
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstAvSyncTestMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+gst_avsynctest_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
+{
+  GstAvSyncTestMeta *avsynctest_meta = (GstAvSyncTestMeta *) meta;
+
+  avsynctest_meta->index = 0;
+  avsynctest_meta->sync_point = FALSE;
+  avsynctest_meta->sync_index = 0;
+
+  return TRUE;
+}
+
+static gboolean
+gst_avsynctest_meta_transform (GstBuffer * dest, GstMeta * meta, GstBuffer * buffer,
+    GQuark type, gpointer data)
+{
+  GstAvSyncTestMeta *avsynctest_meta = (GstAvSyncTestMeta *) meta;
+
+  // a partial copy may no longer start at index, so only whole copies keep the meta
+  if (!GST_META_TRANSFORM_IS_COPY (type)) {
+    return FALSE;
+  }
+
+  GstMetaTransformCopy *copy = data;
+  if (copy->region) {
+    return FALSE;
+  }
+
+  return gst_buffer_add_avsynctest_meta (dest, avsynctest_meta->index,
+      avsynctest_meta->sync_point, avsynctest_meta->sync_index) != NULL;
+}
+
+const GstMetaInfo *
+gst_avsynctest_meta_get_info (void)
+{
+  static const GstMetaInfo *meta_info = NULL;
+
+  if (g_once_init_enter ((GstMetaInfo **) & meta_info)) {
+    const GstMetaInfo *mi = gst_meta_register (GST_AV_SYNC_TEST_META_API_TYPE,
+        "GstAvSyncTestMeta",
+        sizeof (GstAvSyncTestMeta),
+        gst_avsynctest_meta_init,
+        (GstMetaFreeFunction) NULL,
+        gst_avsynctest_meta_transform);
+    g_once_init_leave ((GstMetaInfo **) & meta_info, (GstMetaInfo *) mi);
+  }
+  return meta_info;
+}
+
+GstAvSyncTestMeta *
+gst_buffer_add_avsynctest_meta (GstBuffer * buffer, guint64 index, gboolean sync_point, guint64 sync_index)
+{
+  GstAvSyncTestMeta *meta = (GstAvSyncTestMeta *) gst_buffer_add_meta (buffer, GST_AV_SYNC_TEST_META_INFO, NULL);
+
+  meta->index = index;
+  meta->sync_point = sync_point;
+  meta->sync_index = sync_index;
+
+  return meta;
+}
+
+/*
+ * Stamps buffer with the current time of the clock of element. Nothing is
+ * added before the element was given a clock.
+ */
+void
+gst_avsynctest_buffer_add_reference_timestamp (GstElement * element, GstBuffer * buffer)
+{
+  GstClock *clock = gst_element_get_clock (element);
+  if (clock == NULL) {
+    return;
+  }
+
+  GstCaps *caps = gst_static_caps_get (&reference_caps);
+  gst_buffer_add_reference_timestamp_meta (buffer, caps, gst_clock_get_time (clock), GST_CLOCK_TIME_NONE);
+
+  gst_caps_unref (caps);
+  gst_object_unref (clock);
+}
@@ -0,0 +1,65 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_META_H_
+#define _GST_AV_SYNC_TEST_META_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* media-type of the GstReferenceTimestampMeta holding the clock-time a buffer was generated at */
+#define GST_AV_SYNC_TEST_REFERENCE_CAPS "timestamp/x-avsynctest-clock"
+
+#define GST_AV_SYNC_TEST_META_API_TYPE (gst_avsynctest_meta_api_get_type ())
+#define GST_AV_SYNC_TEST_META_INFO (gst_avsynctest_meta_get_info ())
+
+#define gst_buffer_get_avsynctest_meta(b) \
+  ((GstAvSyncTestMeta *) gst_buffer_get_meta ((b), GST_AV_SYNC_TEST_META_API_TYPE))
+
+typedef struct _GstAvSyncTestMeta GstAvSyncTestMeta;
+
+/*
+ * Describes the position of a buffer on the sync-test timeline, so
+ * downstream elements can find the sync-points without looking at the
+ * pixels or samples. Elements outside this plugin can look the API up by
+ * its name "GstAvSyncTestMetaAPI".
+ */
+struct _GstAvSyncTestMeta
+{
+  GstMeta meta;
+
+  /* frame- or sample-index of the first frame or sample in the buffer */
+  guint64 index;
+
+  /* whether the buffer holds a sync-point, and the frame- or sample-index of
+   * the first one, which is only meaningful when sync_point is set */
+  gboolean sync_point;
+  guint64 sync_index;
+};
+
+GType gst_avsynctest_meta_api_get_type (void);
+const GstMetaInfo *gst_avsynctest_meta_get_info (void);
+
+GstAvSyncTestMeta *gst_buffer_add_avsynctest_meta (GstBuffer * buffer, guint64 index,
+    gboolean sync_point, guint64 sync_index);
+
+void gst_avsynctest_buffer_add_reference_timestamp (GstElement * element, GstBuffer * buffer);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_META_H_
@@ -0,0 +1,189 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+#include "avsynctestraster.h"
+
+/* 5x7 digit atlas, one byte per row, the most significant of 5 bits left */
+#define GLYPH_WIDTH (5)
+#define GLYPH_HEIGHT (7)
+#define GLYPH_ADVANCE (6)
+#define GLYPH_ASCENT (9)
+
+static const guint8 digit_atlas[10][GLYPH_HEIGHT] = {
+  {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},
+  {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+  {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},
+  {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+  {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},
+  {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+  {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},
+  {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+  {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},
+  {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+};
+
+void
+gst_avsynctest_coverage_map_init (GstAvSyncTestCoverageMap * map, gint width, gint height)
+{
+  map->width = width;
+  map->height = height;
+  map->stride = GST_ROUND_UP_4 (width);
+  map->data = g_malloc0 ((gsize) map->stride * height);
+}
+
+void
+gst_avsynctest_coverage_map_clear (GstAvSyncTestCoverageMap * map)
+{
+  g_free (map->data);
+  memset (map, 0, sizeof (GstAvSyncTestCoverageMap));
+}
+
+void
+gst_avsynctest_raster_erase (GstAvSyncTestCoverageMap * map)
+{
+  memset (map->data, 0, (gsize) map->stride * map->height);
+}
+
+/* composites coverage a OVER the coverage already at dest */
+static inline void
+gst_avsynctest_raster_blend (guint8 * dest, gint a)
+{
+  *dest = a + (*dest * (255 - a) + 127) / 255;
+}
+
+/* area of the pixel starting at p that lies within [start, end) */
+static inline double
+gst_avsynctest_raster_overlap (gint p, double start, double end)
+{
+  return MAX (0.0, MIN (p + 1.0, end) - MAX ((double) p, start));
+}
+
+void
+gst_avsynctest_raster_fill_rect (GstAvSyncTestCoverageMap * map, double left, double top, double width, double height)
+{
+  double right = MIN (left + width, map->width);
+  double bottom = MIN (top + height, map->height);
+  left = MAX (left, 0);
+  top = MAX (top, 0);
+
+  if (right <= left || bottom <= top) {
+    return;
+  }
+
+  gint x_start = (gint) floor (left), x_end = (gint) ceil (right);
+  gint y_start = (gint) floor (top), y_end = (gint) ceil (bottom);
+
+  // the columns the rectangle covers completely
+  gint full_start = (gint) ceil (left), full_end = (gint) floor (right);
+
+  for (gint y = y_start; y < y_end; y++) {
+    guint8 *row = map->data + y * map->stride;
+    double coverage_y = gst_avsynctest_raster_overlap (y, top, bottom);
+
+    for (gint x = x_start; x < x_end; x++) {
+      if (coverage_y >= 1.0 && x >= full_start && x < full_end) {
+        memset (row + x, 0xFF, full_end - x);
+        x = full_end - 1;
+        continue;
+      }
+
+      gint a = (gint) lrint (gst_avsynctest_raster_overlap (x, left, right) * coverage_y * 255);
+      gst_avsynctest_raster_blend (row + x, a);
+    }
+  }
+}
+
+/* only horizontal and vertical lines, with butt caps like cairo draws them */
+void
+gst_avsynctest_raster_line (GstAvSyncTestCoverageMap * map, double x0, double y0, double x1, double y1, double line_width)
+{
+  if (y0 == y1) {
+    gst_avsynctest_raster_fill_rect (map, MIN (x0, x1), y0 - line_width / 2, fabs (x1 - x0), line_width);
+  } else {
+    g_warn_if_fail (x0 == x1);
+    gst_avsynctest_raster_fill_rect (map, x0 - line_width / 2, MIN (y0, y1), line_width, fabs (y1 - y0));
+  }
+}
+
+/* the four sides do not overlap, so the corners are not composited twice */
+void
+gst_avsynctest_raster_rect_outline (GstAvSyncTestCoverageMap * map, double left, double top, double width, double height, double line_width)
+{
+  double half = line_width / 2;
+
+  gst_avsynctest_raster_fill_rect (map, left - half, top - half, width + line_width, line_width);
+  gst_avsynctest_raster_fill_rect (map, left - half, top + height - half, width + line_width, line_width);
+  gst_avsynctest_raster_fill_rect (map, left - half, top + half, line_width, height - line_width);
+  gst_avsynctest_raster_fill_rect (map, left + width - half, top + half, line_width, height - line_width);
+}
+
+/* the atlas is scaled by whole pixels, so the glyphs stay crisp and seamless */
+static gint
+gst_avsynctest_raster_glyph_scale (double size)
+{
+  return MAX (1, (gint) lrint (size / 10));
+}
+
+void
+gst_avsynctest_raster_text_extents (const gchar * text, double size, double *width, double *ascent)
+{
+  gint scale = gst_avsynctest_raster_glyph_scale (size);
+  gint n_glyphs = strlen (text);
+
+  *width = n_glyphs > 0 ? (n_glyphs * GLYPH_ADVANCE - (GLYPH_ADVANCE - GLYPH_WIDTH)) * scale : 0;
+  *ascent = GLYPH_ASCENT * scale;
+}
+
+void
+gst_avsynctest_raster_show_text (GstAvSyncTestCoverageMap * map, const gchar * text, double size, double x, double baseline)
+{
+  gint scale = gst_avsynctest_raster_glyph_scale (size);
+  gint left = (gint) lrint (x);
+  gint top = (gint) lrint (baseline) - GLYPH_HEIGHT * scale;
+
+  for (const gchar *c = text; *c != '\0'; c++, left += GLYPH_ADVANCE * scale) {
+    g_return_if_fail (g_ascii_isdigit (*c));
+    const guint8 *glyph = digit_atlas[*c - '0'];
+
+    for (gint row = 0; row < GLYPH_HEIGHT; row++) {
+      // runs of set bits are filled as one rectangle
+      for (gint col = 0; col < GLYPH_WIDTH; col++) {
+        if (!(glyph[row] & (0x10 >> col))) {
+          continue;
+        }
+
+        gint run = 1;
+        while (col + run < GLYPH_WIDTH && (glyph[row] & (0x10 >> (col + run)))) {
+          run++;
+        }
+
+        gst_avsynctest_raster_fill_rect (map,
+            left + col * scale, top + row * scale,
+            run * scale, scale);
+        col += run;
+      }
+    }
+  }
+}
@@ -0,0 +1,58 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_RASTER_H_
+#define _GST_AV_SYNC_TEST_RASTER_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Coverage-map the test-card is painted into (0 = background, 255 =
+ * foreground). The stride is a multiple of 4, so the same memory can be
+ * wrapped by a cairo A8 surface.
+ */
+typedef struct _GstAvSyncTestCoverageMap
+{
+  guint8 *data;
+  gint width;
+  gint height;
+  gint stride;
+} GstAvSyncTestCoverageMap;
+
+void gst_avsynctest_coverage_map_init (GstAvSyncTestCoverageMap * map, gint width, gint height);
+void gst_avsynctest_coverage_map_clear (GstAvSyncTestCoverageMap * map);
+
+/*
+ * Rasterizer for the only primitives the test-card consists of: axis-aligned
+ * rectangles and lines with exact area-coverage anti-aliasing, and digits
+ * from a built-in bitmap atlas. Everything is composited OVER what has
+ * been painted before.
+ */
+void gst_avsynctest_raster_erase (GstAvSyncTestCoverageMap * map);
+void gst_avsynctest_raster_fill_rect (GstAvSyncTestCoverageMap * map, double left, double top, double width, double height);
+void gst_avsynctest_raster_line (GstAvSyncTestCoverageMap * map, double x0, double y0, double x1, double y1, double line_width);
+void gst_avsynctest_raster_rect_outline (GstAvSyncTestCoverageMap * map, double left, double top, double width, double height, double line_width);
+
+/* text may only consist of digits, size is the em-size in pixels */
+void gst_avsynctest_raster_text_extents (const gchar * text, double size, double *width, double *ascent);
+void gst_avsynctest_raster_show_text (GstAvSyncTestCoverageMap * map, const gchar * text, double size, double x, double baseline);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_RASTER_H_
@@ -0,0 +1,455 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+#include "avsynctestrender.h"
+
+#define COLOR_R(x) ((double)((x & 0x00FF0000) >> 16) / 0xFF)
+#define COLOR_G(x) ((double)((x & 0x0000FF00) >>  8) / 0xFF)
+#define COLOR_B(x) ((double)((x & 0x000000FF) >>  0) / 0xFF)
+
+static guint16
+gst_avsynctest_quantize (double value, gint offset, gint scale, gint max)
+{
+  return CLAMP (lrint (offset + value * scale), 0, max);
+}
+
+void
+gst_avsynctest_palette_init (GstAvSyncTestPalette * palette, const GstVideoInfo * info, guint foreground_color, guint background_color)
+{
+  gint offset[GST_VIDEO_MAX_COMPONENTS];
+  gint scale[GST_VIDEO_MAX_COMPONENTS];
+  gst_video_color_range_offsets (info->colorimetry.range, info->finfo, offset, scale);
+
+  gdouble Kr, Kb;
+  if (!gst_video_color_matrix_get_Kr_Kb (info->colorimetry.matrix, &Kr, &Kb)) {
+    // RGB formats have no matrix, the YUV tables are unused then
+    Kr = 0.2126;
+    Kb = 0.0722;
+  }
+
+  gint max = (1 << info->finfo->depth[0]) - 1;
+
+  for (gint coverage = 0; coverage < 256; coverage++) {
+    double a = (double) coverage / 255;
+    double r = COLOR_R(background_color) + (COLOR_R(foreground_color) - COLOR_R(background_color)) * a;
+    double g = COLOR_G(background_color) + (COLOR_G(foreground_color) - COLOR_G(background_color)) * a;
+    double b = COLOR_B(background_color) + (COLOR_B(foreground_color) - COLOR_B(background_color)) * a;
+
+    palette->r[coverage] = lrint (r * 0xFF);
+    palette->g[coverage] = lrint (g * 0xFF);
+    palette->b[coverage] = lrint (b * 0xFF);
+
+    double y = Kr * r + (1 - Kr - Kb) * g + Kb * b;
+    double cb = (b - y) / (2 * (1 - Kb));
+    double cr = (r - y) / (2 * (1 - Kr));
+
+    palette->y[coverage] = gst_avsynctest_quantize (y, offset[0], scale[0], max);
+    palette->u[coverage] = gst_avsynctest_quantize (cb, offset[1], scale[1], max);
+    palette->v[coverage] = gst_avsynctest_quantize (cr, offset[2], scale[2], max);
+  }
+}
+
+/* coverage of a chroma-sample covering two horizontally neighbouring pixels */
+static inline guint8
+gst_avsynctest_coverage_h2 (const guint8 * row, gint x, gint width)
+{
+  return (row[x] + row[MIN (x + 1, width - 1)] + 1) / 2;
+}
+
+/* coverage of a chroma-sample covering a 2x2 block of pixels */
+static inline guint8
+gst_avsynctest_coverage_2x2 (const guint8 * row, const guint8 * next_row, gint x, gint width)
+{
+  gint x1 = MIN (x + 1, width - 1);
+  return (row[x] + row[x1] + next_row[x] + next_row[x1] + 2) / 4;
+}
+
+static void
+gst_avsynctest_render_bgrx (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+
+  for (gint y = y_start; y < y_end; y++) {
+    const guint8 *src = coverage + y * coverage_stride;
+    guint8 *dest = data + y * stride;
+
+    for (gint x = 0; x < width; x++, dest += 4) {
+      dest[0] = palette->b[src[x]];
+      dest[1] = palette->g[src[x]];
+      dest[2] = palette->r[src[x]];
+      dest[3] = 0xFF;
+    }
+  }
+}
+
+static void
+gst_avsynctest_render_luma (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+
+  for (gint y = y_start; y < y_end; y++) {
+    const guint8 *src = coverage + y * coverage_stride;
+    guint8 *dest = data + y * stride;
+
+    for (gint x = 0; x < width; x++) {
+      dest[x] = palette->y[src[x]];
+    }
+  }
+}
+
+static void
+gst_avsynctest_render_i420 (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+  gint chroma_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
+
+  gst_avsynctest_render_luma (frame, coverage, coverage_stride, palette, y_start, y_end);
+
+  for (gint cy = y_start / 2; cy < (y_end + 1) / 2; cy++) {
+    const guint8 *row = coverage + (cy * 2) * coverage_stride;
+    const guint8 *next_row = coverage + MIN (cy * 2 + 1, height - 1) * coverage_stride;
+    guint8 *dest_u = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 1) + cy * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 1);
+    guint8 *dest_v = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 2) + cy * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 2);
+
+    for (gint cx = 0; cx < chroma_width; cx++) {
+      guint8 a = gst_avsynctest_coverage_2x2 (row, next_row, cx * 2, width);
+      dest_u[cx] = palette->u[a];
+      dest_v[cx] = palette->v[a];
+    }
+  }
+}
+
+static void
+gst_avsynctest_render_nv12 (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+  gint chroma_width = GST_VIDEO_FRAME_COMP_WIDTH (frame, 1);
+
+  gst_avsynctest_render_luma (frame, coverage, coverage_stride, palette, y_start, y_end);
+
+  for (gint cy = y_start / 2; cy < (y_end + 1) / 2; cy++) {
+    const guint8 *row = coverage + (cy * 2) * coverage_stride;
+    const guint8 *next_row = coverage + MIN (cy * 2 + 1, height - 1) * coverage_stride;
+    guint8 *dest = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 1) + cy * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 1);
+
+    for (gint cx = 0; cx < chroma_width; cx++, dest += 2) {
+      guint8 a = gst_avsynctest_coverage_2x2 (row, next_row, cx * 2, width);
+      dest[0] = palette->u[a];
+      dest[1] = palette->v[a];
+    }
+  }
+}
+
+static void
+gst_avsynctest_render_uyvy (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+
+  for (gint y = y_start; y < y_end; y++) {
+    const guint8 *src = coverage + y * coverage_stride;
+    guint8 *dest = data + y * stride;
+
+    for (gint x = 0; x < width; x += 2, dest += 4) {
+      guint8 a = gst_avsynctest_coverage_h2 (src, x, width);
+      dest[0] = palette->u[a];
+      dest[1] = palette->y[src[x]];
+      dest[2] = palette->v[a];
+      dest[3] = palette->y[src[MIN (x + 1, width - 1)]];
+    }
+  }
+}
+
+static void
+gst_avsynctest_render_v210 (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+
+  for (gint y = y_start; y < y_end; y++) {
+    const guint8 *src = coverage + y * coverage_stride;
+    guint8 *dest = data + y * stride;
+
+    // 6 pixels are packed into 4 little-endian words of 3 10-bit components each
+    for (gint x = 0; x < width; x += 6, dest += 16) {
+      guint16 Y[6], U[3], V[3];
+
+      for (gint i = 0; i < 6; i++) {
+        Y[i] = palette->y[src[MIN (x + i, width - 1)]];
+      }
+
+      for (gint i = 0; i < 3; i++) {
+        guint8 a = gst_avsynctest_coverage_h2 (src, MIN (x + i * 2, width - 1), width);
+        U[i] = palette->u[a];
+        V[i] = palette->v[a];
+      }
+
+      GST_WRITE_UINT32_LE (dest + 0,  U[0] | (Y[0] << 10) | (V[0] << 20));
+      GST_WRITE_UINT32_LE (dest + 4,  Y[1] | (U[1] << 10) | (Y[2] << 20));
+      GST_WRITE_UINT32_LE (dest + 8,  V[1] | (Y[3] << 10) | (U[2] << 20));
+      GST_WRITE_UINT32_LE (dest + 12, Y[4] | (V[2] << 10) | (Y[5] << 20));
+    }
+  }
+}
+
+/*
+ * Render a coverage-map of the frames size into frame, using the
+ * component-values precomputed in palette.
+ */
+gboolean
+gst_avsynctest_render_coverage (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette)
+{
+  return gst_avsynctest_render_coverage_slice (frame, coverage, coverage_stride, palette, 0, 1);
+}
+
+/*
+ * Render only the rows of slice out of n_slices horizontal slices. The
+ * slices are cut on the chroma-rows, so no two slices share a chroma-row.
+ */
+gboolean
+gst_avsynctest_render_coverage_slice (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, guint slice, guint n_slices)
+{
+  gint height = GST_VIDEO_FRAME_HEIGHT (frame);
+  gint chroma_rows = GST_VIDEO_FRAME_COMP_HEIGHT (frame, 1);
+  guint v_sub = GST_VIDEO_FORMAT_INFO_H_SUB (frame->info.finfo, 1);
+
+  gint y_start = gst_avsynctest_slice_row (chroma_rows, slice, n_slices) << v_sub;
+  gint y_end = MIN (gst_avsynctest_slice_row (chroma_rows, slice + 1, n_slices) << v_sub, height);
+
+  return gst_avsynctest_render_coverage_rows (frame, coverage, coverage_stride, palette, y_start, y_end);
+}
+
+/*
+ * Render only the rows from y_start to y_end. With chroma-subsampling
+ * y_start has to be on the first row of a chroma-row.
+ */
+gboolean
+gst_avsynctest_render_coverage_rows (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end)
+{
+  switch (GST_VIDEO_FRAME_FORMAT (frame)) {
+    case GST_VIDEO_FORMAT_BGRx:
+      gst_avsynctest_render_bgrx (frame, coverage, coverage_stride, palette, y_start, y_end);
+      return TRUE;
+
+    case GST_VIDEO_FORMAT_I420:
+      gst_avsynctest_render_i420 (frame, coverage, coverage_stride, palette, y_start, y_end);
+      return TRUE;
+
+    case GST_VIDEO_FORMAT_NV12:
+      gst_avsynctest_render_nv12 (frame, coverage, coverage_stride, palette, y_start, y_end);
+      return TRUE;
+
+    case GST_VIDEO_FORMAT_UYVY:
+      gst_avsynctest_render_uyvy (frame, coverage, coverage_stride, palette, y_start, y_end);
+      return TRUE;
+
+    case GST_VIDEO_FORMAT_v210:
+      gst_avsynctest_render_v210 (frame, coverage, coverage_stride, palette, y_start, y_end);
+      return TRUE;
+
+    default:
+      return FALSE;
+  }
+}
+
+/*
+ * Copy the rows of slice out of n_slices horizontal slices of every plane
+ * from src to dest. The frames may use different strides.
+ */
+void
+gst_avsynctest_frame_copy_slice (GstVideoFrame * dest, const GstVideoFrame * src, guint slice, guint n_slices)
+{
+  for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (dest); plane++) {
+    gint dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, plane);
+    gint src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, plane);
+    gint row_bytes = MIN (dest_stride, src_stride);
+
+    // for all supported formats the n'th plane starts with the n'th component
+    gint rows = GST_VIDEO_FRAME_COMP_HEIGHT (dest, plane);
+    gint first = gst_avsynctest_slice_row (rows, slice, n_slices);
+    gint last = gst_avsynctest_slice_row (rows, slice + 1, n_slices);
+
+    guint8 *dest_data = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (dest, plane);
+    const guint8 *src_data = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (src, plane);
+
+    if (dest_stride == src_stride) {
+      memcpy (dest_data + first * dest_stride, src_data + first * src_stride, (gsize) (last - first) * dest_stride);
+      continue;
+    }
+
+    for (gint row = first; row < last; row++) {
+      memcpy (dest_data + row * dest_stride, src_data + row * src_stride, row_bytes);
+    }
+  }
+}
+
+/*
+ * Find the bounding-box of the bytes that differ between a and b in every
+ * plane. Both frames need to share the same video-info, including the
+ * padding-bytes which are compared as well.
+ */
+void
+gst_avsynctest_dirty_region_diff (const GstVideoFrame * a, const GstVideoFrame * b, GstAvSyncTestDirtyRegion * region)
+{
+  memset (region, 0, sizeof (GstAvSyncTestDirtyRegion));
+
+  for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (a); plane++) {
+    const guint8 *data_a = GST_VIDEO_FRAME_PLANE_DATA (a, plane);
+    const guint8 *data_b = GST_VIDEO_FRAME_PLANE_DATA (b, plane);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (a, plane);
+
+    // for all supported formats the n'th plane starts with the n'th component
+    gint rows = GST_VIDEO_FRAME_COMP_HEIGHT (a, plane);
+
+    gint left = stride, right = -1, top = rows, bottom = -1;
+    for (gint y = 0; y < rows; y++) {
+      const guint8 *row_a = data_a + y * stride;
+      const guint8 *row_b = data_b + y * stride;
+
+      if (memcmp (row_a, row_b, stride) == 0) {
+        continue;
+      }
+
+      gint first = 0, last = stride - 1;
+      while (row_a[first] == row_b[first]) first++;
+      while (row_a[last] == row_b[last]) last--;
+
+      left = MIN (left, first);
+      right = MAX (right, last);
+      top = MIN (top, y);
+      bottom = y;
+    }
+
+    if (bottom >= 0) {
+      region->planes[plane] = (GstAvSyncTestRegion) {
+        .x = left, .y = top, .width = right - left + 1, .height = bottom - top + 1
+      };
+    }
+  }
+}
+
+static GstAvSyncTestRegion
+gst_avsynctest_region_union (const GstAvSyncTestRegion * a, const GstAvSyncTestRegion * b)
+{
+  if (a->width == 0 || a->height == 0) {
+    return *b;
+  }
+
+  if (b->width == 0 || b->height == 0) {
+    return *a;
+  }
+
+  gint left = MIN (a->x, b->x);
+  gint top = MIN (a->y, b->y);
+  gint right = MAX (a->x + a->width, b->x + b->width);
+  gint bottom = MAX (a->y + a->height, b->y + b->height);
+
+  return (GstAvSyncTestRegion) {
+    .x = left, .y = top, .width = right - left, .height = bottom - top
+  };
+}
+
+void
+gst_avsynctest_dirty_region_union (const GstAvSyncTestDirtyRegion * a, const GstAvSyncTestDirtyRegion * b, GstAvSyncTestDirtyRegion * region)
+{
+  for (guint plane = 0; plane < GST_VIDEO_MAX_PLANES; plane++) {
+    region->planes[plane] = gst_avsynctest_region_union (&a->planes[plane], &b->planes[plane]);
+  }
+}
+
+gboolean
+gst_avsynctest_dirty_region_is_empty (const GstAvSyncTestDirtyRegion * region)
+{
+  for (guint plane = 0; plane < GST_VIDEO_MAX_PLANES; plane++) {
+    if (region->planes[plane].width > 0 && region->planes[plane].height > 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/*
+ * Copy only the dirty region from src to dest. The frames may use different
+ * strides, the region must lie within the row-bytes of both.
+ */
+void
+gst_avsynctest_dirty_region_copy (GstVideoFrame * dest, const GstVideoFrame * src, const GstAvSyncTestDirtyRegion * region)
+{
+  gst_avsynctest_dirty_region_copy_slice (dest, src, region, 0, 1);
+}
+
+/* copy the rows of slice out of n_slices horizontal slices of the dirty region */
+void
+gst_avsynctest_dirty_region_copy_slice (GstVideoFrame * dest, const GstVideoFrame * src, const GstAvSyncTestDirtyRegion * region, guint slice, guint n_slices)
+{
+  for (guint plane = 0; plane < GST_VIDEO_FRAME_N_PLANES (dest); plane++) {
+    const GstAvSyncTestRegion *r = &region->planes[plane];
+    gint dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (dest, plane);
+    gint src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (src, plane);
+    guint8 *dest_data = (guint8 *) GST_VIDEO_FRAME_PLANE_DATA (dest, plane) + r->y * dest_stride + r->x;
+    const guint8 *src_data = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (src, plane) + r->y * src_stride + r->x;
+
+    gint first = gst_avsynctest_slice_row (r->height, slice, n_slices);
+    gint last = gst_avsynctest_slice_row (r->height, slice + 1, n_slices);
+
+    for (gint row = first; row < last; row++) {
+      memcpy (dest_data + row * dest_stride, src_data + row * src_stride, r->width);
+    }
+  }
+}
+
+/* 8 bit luma of the pixel at x/y, only the first luma sample of a v210 block is looked at */
+guint8
+gst_avsynctest_luma_at (const GstVideoFrame * frame, gint x, gint y)
+{
+  const guint8 *row = (const guint8 *) GST_VIDEO_FRAME_PLANE_DATA (frame, 0) + y * GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+
+  switch (GST_VIDEO_FRAME_FORMAT (frame)) {
+    case GST_VIDEO_FORMAT_BGRx:
+    {
+      const guint8 *p = row + x * 4;
+      return (29 * p[0] + 150 * p[1] + 77 * p[2]) >> 8;
+    }
+
+    case GST_VIDEO_FORMAT_UYVY:
+      return row[x * 2 + 1];
+
+    case GST_VIDEO_FORMAT_v210:
+      return ((GST_READ_UINT32_LE (row + (x / 6) * 16) >> 10) & 0x3FF) >> 2;
+
+    default:
+      // I420, NV12
+      return row[x];
+  }
+}
@@ -0,0 +1,87 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_RENDER_H_
+#define _GST_AV_SYNC_TEST_RENDER_H_
+
+#include <gst/video/video.h>
+
+#include "avsynctestslicerunner.h"
+
+G_BEGIN_DECLS
+
+/* formats the coverage of the test-card can be rendered into */
+#define GST_AV_SYNC_TEST_RENDER_FORMATS "{ BGRx, I420, NV12, UYVY, v210 }"
+
+/* geometry of the flash-rectangle, relative to the frame size */
+#define GST_AV_SYNC_TEST_FLASH_LEFT (0.07)
+#define GST_AV_SYNC_TEST_FLASH_TOP (0.1)
+#define GST_AV_SYNC_TEST_FLASH_WIDTH (0.4)
+#define GST_AV_SYNC_TEST_FLASH_HEIGHT (0.3)
+
+/*
+ * The test-card only consists of foreground- and background-color. It is
+ * painted as a coverage-map (0 = background, 255 = foreground) and then
+ * rendered into the negotiated format through per-component lookup-tables,
+ * that hold the precomputed component-value for every coverage-value.
+ */
+typedef struct _GstAvSyncTestPalette
+{
+  guint8 r[256];
+  guint8 g[256];
+  guint8 b[256];
+
+  /* in the bit-depth of the negotiated format */
+  guint16 y[256];
+  guint16 u[256];
+  guint16 v[256];
+} GstAvSyncTestPalette;
+
+/* rectangular region of a plane, x and width in bytes, y and height in rows */
+typedef struct _GstAvSyncTestRegion
+{
+  gint x;
+  gint y;
+  gint width;
+  gint height;
+} GstAvSyncTestRegion;
+
+/* the regions of all planes of a frame that differ from another frame */
+typedef struct _GstAvSyncTestDirtyRegion
+{
+  GstAvSyncTestRegion planes[GST_VIDEO_MAX_PLANES];
+} GstAvSyncTestDirtyRegion;
+
+void gst_avsynctest_palette_init (GstAvSyncTestPalette * palette, const GstVideoInfo * info, guint foreground_color, guint background_color);
+
+gboolean gst_avsynctest_render_coverage (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette);
+gboolean gst_avsynctest_render_coverage_slice (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, guint slice, guint n_slices);
+gboolean gst_avsynctest_render_coverage_rows (GstVideoFrame * frame, const guint8 * coverage, gint coverage_stride, const GstAvSyncTestPalette * palette, gint y_start, gint y_end);
+
+void gst_avsynctest_frame_copy_slice (GstVideoFrame * dest, const GstVideoFrame * src, guint slice, guint n_slices);
+
+void gst_avsynctest_dirty_region_diff (const GstVideoFrame * a, const GstVideoFrame * b, GstAvSyncTestDirtyRegion * region);
+void gst_avsynctest_dirty_region_union (const GstAvSyncTestDirtyRegion * a, const GstAvSyncTestDirtyRegion * b, GstAvSyncTestDirtyRegion * region);
+gboolean gst_avsynctest_dirty_region_is_empty (const GstAvSyncTestDirtyRegion * region);
+void gst_avsynctest_dirty_region_copy (GstVideoFrame * dest, const GstVideoFrame * src, const GstAvSyncTestDirtyRegion * region);
+void gst_avsynctest_dirty_region_copy_slice (GstVideoFrame * dest, const GstVideoFrame * src, const GstAvSyncTestDirtyRegion * region, guint slice, guint n_slices);
+
+guint8 gst_avsynctest_luma_at (const GstVideoFrame * frame, gint x, gint y);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_RENDER_H_
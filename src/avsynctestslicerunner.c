@@ -0,0 +1,151 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctestslicerunner.h"
+
+typedef struct
+{
+  GstAvSyncTestSliceRunner *runner;
+  /* the slice this worker runs, slice 0 is run by the calling thread */
+  guint slice;
+} GstAvSyncTestSliceWorker;
+
+static gpointer
+gst_avsynctest_slice_runner_worker (gpointer data)
+{
+  GstAvSyncTestSliceWorker *worker = data;
+  GstAvSyncTestSliceRunner *runner = worker->runner;
+  guint seen_generation = 0;
+
+  g_mutex_lock (&runner->lock);
+  while (TRUE) {
+    while (!runner->quit && runner->generation == seen_generation) {
+      g_cond_wait (&runner->job_cond, &runner->lock);
+    }
+
+    if (runner->quit) {
+      break;
+    }
+
+    seen_generation = runner->generation;
+    if (worker->slice >= runner->n_slices) {
+      // job uses fewer slices than there are threads
+      continue;
+    }
+
+    GstAvSyncTestSliceFunc func = runner->func;
+    gpointer user_data = runner->user_data;
+    guint n_slices = runner->n_slices;
+
+    g_mutex_unlock (&runner->lock);
+    func (user_data, worker->slice, n_slices);
+    g_mutex_lock (&runner->lock);
+
+    if (--runner->pending == 0) {
+      g_cond_signal (&runner->done_cond);
+    }
+  }
+  g_mutex_unlock (&runner->lock);
+
+  g_free (worker);
+  return NULL;
+}
+
+GstAvSyncTestSliceRunner *
+gst_avsynctest_slice_runner_new (guint n_threads)
+{
+  GstAvSyncTestSliceRunner *runner = g_new0 (GstAvSyncTestSliceRunner, 1);
+  runner->n_threads = MAX (n_threads, 1);
+
+  g_mutex_init (&runner->lock);
+  g_cond_init (&runner->job_cond);
+  g_cond_init (&runner->done_cond);
+
+  runner->workers = g_new0 (GThread *, runner->n_threads);
+  for (guint i = 1; i < runner->n_threads; i++) {
+    GstAvSyncTestSliceWorker *worker = g_new0 (GstAvSyncTestSliceWorker, 1);
+    worker->runner = runner;
+    worker->slice = i;
+
+    gchar *name = g_strdup_printf ("avsynctest-slice-%u", i);
+    runner->workers[i] = g_thread_new (name, gst_avsynctest_slice_runner_worker, worker);
+    g_free (name);
+  }
+
+  return runner;
+}
+
+void
+gst_avsynctest_slice_runner_free (GstAvSyncTestSliceRunner * runner)
+{
+  if (runner == NULL) {
+    return;
+  }
+
+  g_mutex_lock (&runner->lock);
+  runner->quit = TRUE;
+  g_cond_broadcast (&runner->job_cond);
+  g_mutex_unlock (&runner->lock);
+
+  for (guint i = 1; i < runner->n_threads; i++) {
+    g_thread_join (runner->workers[i]);
+  }
+
+  g_free (runner->workers);
+  g_cond_clear (&runner->done_cond);
+  g_cond_clear (&runner->job_cond);
+  g_mutex_clear (&runner->lock);
+  g_free (runner);
+}
+
+/*
+ * Run func for every slice of n_slices and wait for all of them to finish.
+ * n_slices is clamped to the number of threads of the runner.
+ */
+void
+gst_avsynctest_slice_runner_run (GstAvSyncTestSliceRunner * runner, guint n_slices, GstAvSyncTestSliceFunc func, gpointer user_data)
+{
+  n_slices = CLAMP (n_slices, 1, runner->n_threads);
+
+  if (n_slices == 1) {
+    func (user_data, 0, 1);
+    return;
+  }
+
+  g_mutex_lock (&runner->lock);
+  runner->func = func;
+  runner->user_data = user_data;
+  runner->n_slices = n_slices;
+  runner->pending = n_slices - 1;
+  runner->generation++;
+  g_cond_broadcast (&runner->job_cond);
+  g_mutex_unlock (&runner->lock);
+
+  func (user_data, 0, n_slices);
+
+  g_mutex_lock (&runner->lock);
+  while (runner->pending > 0) {
+    g_cond_wait (&runner->done_cond, &runner->lock);
+  }
+  g_mutex_unlock (&runner->lock);
+}
@@ -0,0 +1,65 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_SLICE_RUNNER_H_
+#define _GST_AV_SYNC_TEST_SLICE_RUNNER_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* runs slice of n_slices, every slice exactly once per gst_avsynctest_slice_runner_run */
+typedef void (*GstAvSyncTestSliceFunc) (gpointer user_data, guint slice, guint n_slices);
+
+/*
+ * Persistent pool of worker-threads, each running one slice of a job. The
+ * calling thread runs the first slice itself and returns when all slices
+ * are done, so a runner with one thread never spawns any.
+ */
+typedef struct _GstAvSyncTestSliceRunner
+{
+  guint n_threads;
+  GThread **workers;
+
+  GMutex lock;
+  GCond job_cond;
+  GCond done_cond;
+
+  /* the current job, incremented generation wakes the workers */
+  GstAvSyncTestSliceFunc func;
+  gpointer user_data;
+  guint n_slices;
+  guint generation;
+  guint pending;
+  gboolean quit;
+} GstAvSyncTestSliceRunner;
+
+GstAvSyncTestSliceRunner *gst_avsynctest_slice_runner_new (guint n_threads);
+void gst_avsynctest_slice_runner_free (GstAvSyncTestSliceRunner * runner);
+
+void gst_avsynctest_slice_runner_run (GstAvSyncTestSliceRunner * runner, guint n_slices, GstAvSyncTestSliceFunc func, gpointer user_data);
+
+/* the first of the rows belonging to slice, slice n_slices ends the last one */
+static inline gint
+gst_avsynctest_slice_row (gint rows, guint slice, guint n_slices)
+{
+  return (gint) ((gint64) rows * slice / n_slices);
+}
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_SLICE_RUNNER_H_
@@ -23,6 +23,9 @@
 
 #include "avsynctestvideosrc.h"
 #include "avsynctestaudiosrc.h"
+#include "avsyncanalyzer.h"
+#include "avsynctestsrc.h"
+#include "avsynctimecodereader.h"
 
 static gboolean
 plugin_init (GstPlugin * plugin)
@@ -31,6 +34,12 @@ plugin_init (GstPlugin * plugin)
 		GST_TYPE_AV_SYNC_TEST_VIDEO_SRC);
 	gst_element_register (plugin, "avsynctestaudiosrc", GST_RANK_NONE,
 		GST_TYPE_AV_SYNC_TEST_AUDIO_SRC);
+	gst_element_register (plugin, "avsyncanalyzer", GST_RANK_NONE,
+		GST_TYPE_AV_SYNC_ANALYZER);
+	gst_element_register (plugin, "avsynctestsrc", GST_RANK_NONE,
+		GST_TYPE_AV_SYNC_TEST_SRC);
+	gst_element_register (plugin, "avsynctimecodereader", GST_RANK_NONE,
+		GST_TYPE_AV_SYNC_TIMECODE_READER);
 
 	return TRUE;
 }
@@ -0,0 +1,213 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctestsrc.h"
+#include "avsynctestvideosrc.h"
+#include "avsynctestaudiosrc.h"
+#include "avsynctestencoder.h"
+#include "avsynctesttimeline.h"
+
+/* properties, forwarded to both children */
+enum
+{
+  PROP_0,
+  PROP_SYNC_INTERVAL,
+  PROP_SYNC_INTERVAL_FRAMES,
+  PROP_SYNC_PATTERN,
+};
+
+/* property defaults */
+#define PROP_SYNC_INTERVAL_DEFAULT (GST_SECOND)
+#define PROP_SYNC_INTERVAL_FRAMES_DEFAULT (0)
+#define PROP_SYNC_PATTERN_DEFAULT (GST_AV_SYNC_TEST_SYNC_PATTERN_SINGLE)
+
+/* pad templates */
+static GstStaticPadTemplate video_srctemplate = GST_STATIC_PAD_TEMPLATE ("video",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("video/x-raw; " GST_AV_SYNC_TEST_ENCODED_CAPS)
+);
+
+static GstStaticPadTemplate audio_srctemplate = GST_STATIC_PAD_TEMPLATE ("audio",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("audio/x-raw")
+);
+
+GST_DEBUG_CATEGORY_STATIC (gst_avsynctestsrc_debug);
+#define GST_CAT_DEFAULT gst_avsynctestsrc_debug
+
+/* parent class */
+#define gst_avsynctestsrc_parent_class parent_class
+G_DEFINE_TYPE (GstAvSyncTestSrc, gst_avsynctestsrc, GST_TYPE_BIN);
+
+/* GObject virtual methods */
+static void gst_avsynctestsrc_set_property (GObject * object, guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_avsynctestsrc_get_property (GObject * object, guint property_id, GValue * value, GParamSpec * pspec);
+
+/* pad functions */
+static GstPadProbeReturn gst_avsynctestsrc_video_caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data);
+
+static void
+gst_avsynctestsrc_class_init (GstAvSyncTestSrcClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (gst_avsynctestsrc_debug, "avsynctestsrc", 0, "AV Sync-Test Src");
+
+  gobject_class->set_property = gst_avsynctestsrc_set_property;
+  gobject_class->get_property = gst_avsynctestsrc_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync-Interval",
+          "Time between two Sync-Points in ns, set on both the Video and the Audio.",
+          GST_MSECOND, 3600 * GST_SECOND,
+          PROP_SYNC_INTERVAL_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL_FRAMES,
+      g_param_spec_uint ("sync-interval-frames", "Sync-Interval-Frames",
+          "Frames between two Sync-Points, overrides sync-interval when not 0. Set on both the Video and the Audio.",
+          0, G_MAXINT,
+          PROP_SYNC_INTERVAL_FRAMES_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_PATTERN,
+      g_param_spec_enum ("sync-pattern", "Sync-Pattern",
+          "Flashes and Beeps at every Sync-Point, set on both the Video and the Audio.",
+          GST_TYPE_AV_SYNC_TEST_SYNC_PATTERN,
+          PROP_SYNC_PATTERN_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  gst_element_class_add_static_pad_template (element_class, &video_srctemplate);
+  gst_element_class_add_static_pad_template (element_class, &audio_srctemplate);
+
+  gst_element_class_set_static_metadata (element_class, "AV Sync-Test Src",
+      "Source/Audio/Video/Debug",
+      "Generates the Audio- and the Video-Portion of the AV Sync-Test Signal from one shared Timeline.",
+      "Peter Körner <peter@mazdermind.de>");
+}
+
+/* exposes the src-pad of the child as ghost-pad of the bin */
+static GstPad *
+gst_avsynctestsrc_add_ghost_pad (GstAvSyncTestSrc * src, GstElement * child, const gchar * name)
+{
+  GstPad *target = gst_element_get_static_pad (child, "src");
+  GstPad *pad = gst_ghost_pad_new_from_template (name, target,
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (src), name));
+  gst_object_unref (target);
+
+  gst_element_add_pad (GST_ELEMENT (src), pad);
+  return pad;
+}
+
+static void
+gst_avsynctestsrc_init (GstAvSyncTestSrc * avsynctestsrc)
+{
+  GST_DEBUG_OBJECT (avsynctestsrc, "init");
+
+  avsynctestsrc->video_src = g_object_new (GST_TYPE_AV_SYNC_TEST_VIDEO_SRC, "name", "video", NULL);
+  avsynctestsrc->audio_src = g_object_new (GST_TYPE_AV_SYNC_TEST_AUDIO_SRC, "name", "audio",
+      "wave", GST_AV_SYNC_TEST_AUDIO_SRC_WAVE_SYNC_BEEP, NULL);
+
+  gst_bin_add_many (GST_BIN (avsynctestsrc), avsynctestsrc->video_src, avsynctestsrc->audio_src, NULL);
+
+  avsynctestsrc->video_srcpad = gst_avsynctestsrc_add_ghost_pad (avsynctestsrc,
+      avsynctestsrc->video_src, "video");
+  avsynctestsrc->audio_srcpad = gst_avsynctestsrc_add_ghost_pad (avsynctestsrc,
+      avsynctestsrc->audio_src, "audio");
+
+  /*
+   * The audio follows the framerate negotiated on the video. Both start at
+   * sync-point 0 on sample 0 and frame 0, and the caps are negotiated long
+   * before the next sync-point, so which of the two starts first does not matter.
+   */
+  GstPad *video_pad = gst_element_get_static_pad (avsynctestsrc->video_src, "src");
+  gst_pad_add_probe (video_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      gst_avsynctestsrc_video_caps_probe, avsynctestsrc, NULL);
+  gst_object_unref (video_pad);
+}
+
+/* both children always share one timeline, the video holds the value read back */
+static void
+gst_avsynctestsrc_set_property (GObject * object, guint property_id, const GValue * value, GParamSpec * pspec)
+{
+  GstAvSyncTestSrc *avsynctestsrc = GST_AV_SYNC_TEST_SRC (object);
+
+  switch (property_id) {
+    case PROP_SYNC_INTERVAL:
+    case PROP_SYNC_INTERVAL_FRAMES:
+    case PROP_SYNC_PATTERN:
+      g_object_set_property (G_OBJECT (avsynctestsrc->video_src), pspec->name, value);
+      g_object_set_property (G_OBJECT (avsynctestsrc->audio_src), pspec->name, value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (avsynctestsrc, property_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_avsynctestsrc_get_property (GObject * object, guint property_id, GValue * value, GParamSpec * pspec)
+{
+  GstAvSyncTestSrc *avsynctestsrc = GST_AV_SYNC_TEST_SRC (object);
+
+  switch (property_id) {
+    case PROP_SYNC_INTERVAL:
+    case PROP_SYNC_INTERVAL_FRAMES:
+    case PROP_SYNC_PATTERN:
+      g_object_get_property (G_OBJECT (avsynctestsrc->video_src), pspec->name, value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (avsynctestsrc, property_id, pspec);
+      break;
+  }
+}
+
+static GstPadProbeReturn
+gst_avsynctestsrc_video_caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstAvSyncTestSrc *avsynctestsrc = GST_AV_SYNC_TEST_SRC (user_data);
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstCaps *caps;
+  gst_event_parse_caps (event, &caps);
+
+  gint fps_n, fps_d;
+  if (!gst_structure_get_fraction (gst_caps_get_structure (caps, 0), "framerate", &fps_n, &fps_d)) {
+    GST_WARNING_OBJECT (avsynctestsrc, "no framerate in video caps %" GST_PTR_FORMAT, caps);
+    return GST_PAD_PROBE_OK;
+  }
+
+  GST_DEBUG_OBJECT (avsynctestsrc, "aligning the audio to %d/%d fps", fps_n, fps_d);
+  g_object_set (avsynctestsrc->audio_src, "sync-framerate", fps_n, fps_d, NULL);
+
+  return GST_PAD_PROBE_OK;
+}
@@ -0,0 +1,53 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_SRC_H_
+#define _GST_AV_SYNC_TEST_SRC_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_AV_SYNC_TEST_SRC           (gst_avsynctestsrc_get_type())
+#define GST_AV_SYNC_TEST_SRC(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_AV_SYNC_TEST_SRC, GstAvSyncTestSrc))
+#define GST_AV_SYNC_TEST_SRC_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),  GST_TYPE_AV_SYNC_TEST_SRC, GstAvSyncTestSrcClass))
+#define GST_IS_AV_SYNC_TEST_SRC(obj)        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_AV_SYNC_TEST_SRC))
+#define GST_IS_AV_SYNC_TEST_SRC_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE((klass),  GST_TYPE_AV_SYNC_TEST_SRC))
+typedef struct _GstAvSyncTestSrc GstAvSyncTestSrc;
+typedef struct _GstAvSyncTestSrcClass GstAvSyncTestSrcClass;
+
+struct _GstAvSyncTestSrc
+{
+  GstBin base_avsynctestsrc;
+
+  // the children, named "video" and "audio" for the child-proxy
+  GstElement *video_src;
+  GstElement *audio_src;
+
+  GstPad *video_srcpad;
+  GstPad *audio_srcpad;
+};
+
+struct _GstAvSyncTestSrcClass
+{
+  GstBinClass base_avsynctestsrc_class;
+};
+
+GType gst_avsynctestsrc_get_type (void);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_SRC_H_
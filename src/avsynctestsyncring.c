@@ -0,0 +1,100 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctestsyncring.h"
+
+#define RING_MASK (GST_AV_SYNC_TEST_SYNC_RING_SIZE - 1)
+
+G_STATIC_ASSERT ((GST_AV_SYNC_TEST_SYNC_RING_SIZE & RING_MASK) == 0);
+
+void
+gst_avsynctest_sync_ring_init (GstAvSyncTestSyncRing * ring)
+{
+  ring->head = 0;
+  ring->tail = 0;
+  ring->dropped = 0;
+  ring->reported_dropped = 0;
+  g_mutex_init (&ring->consumer_lock);
+}
+
+void
+gst_avsynctest_sync_ring_clear (GstAvSyncTestSyncRing * ring)
+{
+  g_mutex_clear (&ring->consumer_lock);
+}
+
+/* producer side, only ever called from the streaming thread */
+gboolean
+gst_avsynctest_sync_ring_push (GstAvSyncTestSyncRing * ring, const GstAvSyncTestSyncEvent * event)
+{
+  guint head = (guint) ring->head;
+  guint tail = (guint) g_atomic_int_get (&ring->tail);
+
+  if (head - tail >= GST_AV_SYNC_TEST_SYNC_RING_SIZE) {
+    g_atomic_int_inc (&ring->dropped);
+    return FALSE;
+  }
+
+  ring->events[head & RING_MASK] = *event;
+
+  // publishes the event written above to the consumer
+  g_atomic_int_set (&ring->head, (gint) (head + 1));
+  return TRUE;
+}
+
+/*
+ * Consumer side, returns the oldest sync-point as structure or NULL when the
+ * ring is empty. The dropped-field counts the events lost since the last
+ * structure returned.
+ */
+GstStructure *
+gst_avsynctest_sync_ring_pull (GstAvSyncTestSyncRing * ring)
+{
+  g_mutex_lock (&ring->consumer_lock);
+
+  guint tail = (guint) ring->tail;
+  guint head = (guint) g_atomic_int_get (&ring->head);
+
+  if (head == tail) {
+    g_mutex_unlock (&ring->consumer_lock);
+    return NULL;
+  }
+
+  GstAvSyncTestSyncEvent event = ring->events[tail & RING_MASK];
+
+  // hands the slot back to the producer
+  g_atomic_int_set (&ring->tail, (gint) (tail + 1));
+
+  guint dropped_total = (guint) g_atomic_int_get (&ring->dropped);
+  guint dropped = dropped_total - (guint) ring->reported_dropped;
+  ring->reported_dropped = (gint) dropped_total;
+
+  g_mutex_unlock (&ring->consumer_lock);
+
+  return gst_structure_new ("sync-point",
+      "pts", G_TYPE_UINT64, event.pts,
+      "running-time", G_TYPE_UINT64, event.running_time,
+      "index", G_TYPE_UINT64, event.index,
+      "dropped", G_TYPE_UINT, dropped,
+      NULL);
+}
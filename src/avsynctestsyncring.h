@@ -0,0 +1,65 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_SYNC_RING_H_
+#define _GST_AV_SYNC_TEST_SYNC_RING_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* number of sync-points held until the consumer drains them, a power of two */
+#define GST_AV_SYNC_TEST_SYNC_RING_SIZE (256)
+
+typedef struct _GstAvSyncTestSyncEvent
+{
+  GstClockTime pts;
+  GstClockTime running_time;
+  /* frame- or sample-index of the sync-point */
+  guint64 index;
+} GstAvSyncTestSyncEvent;
+
+/*
+ * Lock-free single-producer ring of sync-points. The streaming thread
+ * pushes without ever blocking, a full ring drops the new event and counts
+ * it. Consumers are serialized by a mutex among themselves only, so any
+ * thread may drain the ring.
+ */
+typedef struct _GstAvSyncTestSyncRing
+{
+  GstAvSyncTestSyncEvent events[GST_AV_SYNC_TEST_SYNC_RING_SIZE];
+
+  /* free-running positions, head written by the producer, tail by the consumer */
+  gint head;
+  gint tail;
+
+  /* events dropped so far by the producer, and reported so far to consumers */
+  gint dropped;
+  gint reported_dropped;
+
+  GMutex consumer_lock;
+} GstAvSyncTestSyncRing;
+
+void gst_avsynctest_sync_ring_init (GstAvSyncTestSyncRing * ring);
+void gst_avsynctest_sync_ring_clear (GstAvSyncTestSyncRing * ring);
+
+gboolean gst_avsynctest_sync_ring_push (GstAvSyncTestSyncRing * ring, const GstAvSyncTestSyncEvent * event);
+GstStructure *gst_avsynctest_sync_ring_pull (GstAvSyncTestSyncRing * ring);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_SYNC_RING_H_
@@ -0,0 +1,221 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+#include "avsynctesttimecode.h"
+#include "avsynctestrender.h"
+
+/* foreground- and background-level of the cells must differ by this much of 255 to be read */
+#define TIMECODE_MIN_CONTRAST (32)
+
+/* rows of the band, both ends on an even row, so no chroma-row is shared with the test-card */
+void
+gst_avsynctest_timecode_rows (gint height, gint * y_start, gint * y_end)
+{
+  *y_start = ((gint) (GST_AV_SYNC_TEST_TIMECODE_TOP * height)) & ~1;
+  *y_end = ((gint) ((GST_AV_SYNC_TEST_TIMECODE_TOP + GST_AV_SYNC_TEST_TIMECODE_HEIGHT) * height)) & ~1;
+  *y_end = MIN (MAX (*y_end, *y_start + 2), height);
+}
+
+/* left edge of the cell, on an even column like the rows */
+static gint
+gst_avsynctest_timecode_cell_x (gint cell, gint width)
+{
+  gdouble x = GST_AV_SYNC_TEST_TIMECODE_LEFT + GST_AV_SYNC_TEST_TIMECODE_WIDTH * cell / GST_AV_SYNC_TEST_TIMECODE_CELLS;
+  return ((gint) lround (x * width)) & ~1;
+}
+
+/* value of every cell for the frame-counter */
+static void
+gst_avsynctest_timecode_cells (guint32 frame, gboolean cells[GST_AV_SYNC_TEST_TIMECODE_CELLS])
+{
+  gboolean parity = FALSE;
+
+  cells[0] = TRUE;
+  cells[1] = FALSE;
+
+  for (gint bit = 0; bit < GST_AV_SYNC_TEST_TIMECODE_BITS; bit++) {
+    cells[2 + bit] = (frame >> (GST_AV_SYNC_TEST_TIMECODE_BITS - 1 - bit)) & 1;
+    parity ^= cells[2 + bit];
+  }
+
+  cells[GST_AV_SYNC_TEST_TIMECODE_CELLS - 1] = parity;
+}
+
+/*
+ * Paint the band for the frame-counter into the rows of the coverage-map
+ * returned by gst_avsynctest_timecode_rows. The rows are painted across the
+ * whole width, so rendering them replaces the band of the previous frame.
+ */
+void
+gst_avsynctest_timecode_paint (GstAvSyncTestCoverageMap * coverage, guint32 frame)
+{
+  gint y_start, y_end;
+  gst_avsynctest_timecode_rows (coverage->height, &y_start, &y_end);
+
+  gboolean cells[GST_AV_SYNC_TEST_TIMECODE_CELLS];
+  gst_avsynctest_timecode_cells (frame, cells);
+
+  guint8 *row = coverage->data + y_start * coverage->stride;
+  memset (row, 0, coverage->width);
+
+  for (gint cell = 0; cell < GST_AV_SYNC_TEST_TIMECODE_CELLS; cell++) {
+    if (cells[cell]) {
+      gint x = gst_avsynctest_timecode_cell_x (cell, coverage->width);
+      gint x_end = gst_avsynctest_timecode_cell_x (cell + 1, coverage->width);
+      memset (row + x, 0xFF, MIN (x_end, coverage->width) - x);
+    }
+  }
+
+  for (gint y = y_start + 1; y < y_end; y++) {
+    memcpy (coverage->data + y * coverage->stride, row, coverage->width);
+  }
+}
+
+/*
+ * Read the frame-counter back from the band of a frame in any of the
+ * render-formats. Only the center of every cell is looked at, the levels
+ * are compared against the reference-cells, so the colors of the test-card
+ * and the range of the format do not matter.
+ */
+gboolean
+gst_avsynctest_timecode_read (const GstVideoFrame * frame, guint32 * frame_index)
+{
+  gint width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint y_start, y_end;
+  gst_avsynctest_timecode_rows (GST_VIDEO_FRAME_HEIGHT (frame), &y_start, &y_end);
+  gint y = (y_start + y_end) / 2;
+
+  guint8 levels[GST_AV_SYNC_TEST_TIMECODE_CELLS];
+  for (gint cell = 0; cell < GST_AV_SYNC_TEST_TIMECODE_CELLS; cell++) {
+    gint x = (gst_avsynctest_timecode_cell_x (cell, width) + gst_avsynctest_timecode_cell_x (cell + 1, width)) / 2;
+    levels[cell] = gst_avsynctest_luma_at (frame, CLAMP (x, 0, width - 1), y);
+  }
+
+  gint foreground = levels[0];
+  gint background = levels[1];
+  if (ABS (foreground - background) < TIMECODE_MIN_CONTRAST) {
+    return FALSE;
+  }
+
+  gint threshold = (foreground + background) / 2;
+  guint32 value = 0;
+  gboolean parity = FALSE;
+
+  for (gint cell = 2; cell < GST_AV_SYNC_TEST_TIMECODE_CELLS; cell++) {
+    // the foreground may be darker than the background
+    gboolean bit = (levels[cell] > threshold) == (foreground > background);
+    parity ^= bit;
+
+    if (cell < GST_AV_SYNC_TEST_TIMECODE_CELLS - 1) {
+      value = (value << 1) | bit;
+    }
+  }
+
+  if (parity) {
+    return FALSE;
+  }
+
+  *frame_index = value;
+  return TRUE;
+}
+
+/* video-frames counted per LTC-frame, to bring the LTC-framerate to 30 fps or below */
+guint
+gst_avsynctest_ltc_frames_per_code (gint fps_n, gint fps_d)
+{
+  guint n = 1;
+  while ((guint64) fps_n > (guint64) GST_AV_SYNC_TEST_LTC_MAX_FPS * fps_d * n) {
+    n *= 2;
+  }
+
+  return n;
+}
+
+/* writes value into n bits from first, LSB first like they are transmitted */
+static void
+gst_avsynctest_ltc_set_bits (gboolean bits[GST_AV_SYNC_TEST_LTC_BITS], gint first, gint n, guint value)
+{
+  for (gint i = 0; i < n; i++) {
+    bits[first + i] = (value >> i) & 1;
+  }
+}
+
+/*
+ * Encode the LTC-frame number code of a video of fps_n/fps_d into the
+ * levels of its 160 half-bits. The timecode counts non-drop-frame at the
+ * nominal LTC-framerate, the 32 user-bits carry user_bits. Every LTC-frame
+ * starts on the same level, so it can be generated without knowing the
+ * frames before it.
+ */
+void
+gst_avsynctest_ltc_encode (guint64 code, gint fps_n, gint fps_d, guint32 user_bits, guint8 levels[GST_AV_SYNC_TEST_LTC_HALF_BITS])
+{
+  guint64 per_code = (guint64) fps_d * gst_avsynctest_ltc_frames_per_code (fps_n, fps_d);
+  guint nominal = MAX ((fps_n + per_code / 2) / per_code, 1);
+
+  guint frames = code % nominal;
+  guint64 seconds = code / nominal;
+  guint secs = seconds % 60;
+  guint mins = (seconds / 60) % 60;
+  guint hours = (seconds / 3600) % 24;
+
+  gboolean bits[GST_AV_SYNC_TEST_LTC_BITS] = { 0, };
+  gst_avsynctest_ltc_set_bits (bits, 0, 4, frames % 10);
+  gst_avsynctest_ltc_set_bits (bits, 8, 2, frames / 10);
+  gst_avsynctest_ltc_set_bits (bits, 16, 4, secs % 10);
+  gst_avsynctest_ltc_set_bits (bits, 24, 3, secs / 10);
+  gst_avsynctest_ltc_set_bits (bits, 32, 4, mins % 10);
+  gst_avsynctest_ltc_set_bits (bits, 40, 3, mins / 10);
+  gst_avsynctest_ltc_set_bits (bits, 48, 4, hours % 10);
+  gst_avsynctest_ltc_set_bits (bits, 56, 2, hours / 10);
+
+  // the user-bits are interleaved in groups of 4, least significant first
+  for (gint group = 0; group < 8; group++) {
+    gst_avsynctest_ltc_set_bits (bits, 4 + group * 8, 4, user_bits >> (group * 4));
+  }
+
+  // sync-word 0011 1111 1111 1101
+  gst_avsynctest_ltc_set_bits (bits, 64, 16, 0xBFFC);
+
+  // the polarity-correction bit makes the number of ones, and so of transitions, even
+  gint polarity_bit = nominal == 25 ? 59 : 27;
+  gint ones = 0;
+  for (gint bit = 0; bit < GST_AV_SYNC_TEST_LTC_BITS; bit++) {
+    ones += bits[bit];
+  }
+  bits[polarity_bit] = ones % 2;
+
+  // biphase-mark: a transition at the start of every bit and another one within every one
+  guint8 level = 0;
+  for (gint bit = 0; bit < GST_AV_SYNC_TEST_LTC_BITS; bit++) {
+    level ^= 1;
+    levels[2 * bit] = level;
+
+    if (bits[bit]) {
+      level ^= 1;
+    }
+    levels[2 * bit + 1] = level;
+  }
+}
@@ -0,0 +1,59 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_TIMECODE_H_
+#define _GST_AV_SYNC_TEST_TIMECODE_H_
+
+#include <gst/video/video.h>
+
+#include "avsynctestraster.h"
+
+G_BEGIN_DECLS
+
+/* geometry of the band carrying the frame-counter, relative to the frame size */
+#define GST_AV_SYNC_TEST_TIMECODE_LEFT (0.04)
+#define GST_AV_SYNC_TEST_TIMECODE_TOP (0.91)
+#define GST_AV_SYNC_TEST_TIMECODE_WIDTH (0.9)
+#define GST_AV_SYNC_TEST_TIMECODE_HEIGHT (0.05)
+
+/*
+ * The band is a row of cells: a foreground and a background reference-cell,
+ * the 32 bit frame-counter MSB first and an even parity-bit over it.
+ */
+#define GST_AV_SYNC_TEST_TIMECODE_BITS (32)
+#define GST_AV_SYNC_TEST_TIMECODE_CELLS (2 + GST_AV_SYNC_TEST_TIMECODE_BITS + 1)
+
+/*
+ * SMPTE 12M linear timecode. Every LTC-frame is sent as 80 bits in
+ * biphase-mark code, which is 160 half-bits of constant level.
+ */
+#define GST_AV_SYNC_TEST_LTC_BITS (80)
+#define GST_AV_SYNC_TEST_LTC_HALF_BITS (2 * GST_AV_SYNC_TEST_LTC_BITS)
+
+/* highest framerate LTC is defined for, faster video is counted in pairs or quads of frames */
+#define GST_AV_SYNC_TEST_LTC_MAX_FPS (30)
+
+void gst_avsynctest_timecode_rows (gint height, gint * y_start, gint * y_end);
+void gst_avsynctest_timecode_paint (GstAvSyncTestCoverageMap * coverage, guint32 frame);
+gboolean gst_avsynctest_timecode_read (const GstVideoFrame * frame, guint32 * frame_index);
+
+guint gst_avsynctest_ltc_frames_per_code (gint fps_n, gint fps_d);
+void gst_avsynctest_ltc_encode (guint64 code, gint fps_n, gint fps_d, guint32 user_bits, guint8 levels[GST_AV_SYNC_TEST_LTC_HALF_BITS]);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_TIMECODE_H_
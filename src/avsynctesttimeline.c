@@ -0,0 +1,274 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctesttimeline.h"
+
+/* period of the pseudo-random pattern, in sync-points */
+#define PSEUDO_RANDOM_PERIOD (127)
+
+/*
+ * One period of the maximum-length sequence of x^7 + x^6 + 1, LSB first.
+ * Every 7 consecutive sync-points form a unique pattern, so a marker can
+ * be told apart from the others of the last 127 sync-points.
+ */
+static const guint8 pseudo_random_bits[16] = {
+  0xc1, 0x50, 0x3c, 0xd1, 0x5c, 0xf9, 0xc2, 0x91, 0x6c, 0xed, 0x8d, 0xa5, 0x3b, 0x53, 0xfd, 0x01
+};
+
+GType
+gst_avsynctest_sync_pattern_get_type (void)
+{
+  static GType pattern_type = 0;
+  static const GEnumValue pattern_types[] = {
+    {GST_AV_SYNC_TEST_SYNC_PATTERN_SINGLE, "One Flash and Beep at every Sync-Point", "single"},
+    {GST_AV_SYNC_TEST_SYNC_PATTERN_DOUBLE, "Two Flashes and Beeps at every Sync-Point", "double"},
+    {GST_AV_SYNC_TEST_SYNC_PATTERN_PSEUDO_RANDOM, "One or two Flashes and Beeps in a Sequence repeating every 127 Sync-Points", "pseudo-random"},
+    {0, NULL, NULL},
+  };
+
+  if (!pattern_type) {
+    pattern_type = g_enum_register_static ("GstAvSyncTestSyncPattern", pattern_types);
+  }
+  return pattern_type;
+}
+
+void
+gst_avsynctest_timeline_init (GstAvSyncTestTimeline * timeline, gint fps_n, gint fps_d,
+    GstClockTime interval, guint interval_frames, GstAvSyncTestSyncPattern pattern)
+{
+  timeline->fps_n = fps_n;
+  timeline->fps_d = MAX (fps_d, 1);
+  timeline->interval = MAX (interval, 1);
+  timeline->interval_frames = interval_frames;
+  timeline->pattern = pattern;
+}
+
+static gboolean
+gst_avsynctest_timeline_counts_frames (const GstAvSyncTestTimeline * timeline)
+{
+  return timeline->interval_frames > 0 && timeline->fps_n > 0;
+}
+
+/* index of the frame sync-point k is shown on, always 0 without a framerate */
+guint64
+gst_avsynctest_timeline_sync_frame (const GstAvSyncTestTimeline * timeline, guint64 k)
+{
+  if (timeline->fps_n <= 0) {
+    return 0;
+  }
+
+  if (gst_avsynctest_timeline_counts_frames (timeline)) {
+    return k * timeline->interval_frames;
+  }
+
+  return gst_util_uint64_scale_ceil (k * timeline->interval, timeline->fps_n, (guint64) timeline->fps_d * GST_SECOND);
+}
+
+/* the last sync-point shown at or before frame */
+guint64
+gst_avsynctest_timeline_sync_point_at_frame (const GstAvSyncTestTimeline * timeline, guint64 frame)
+{
+  if (timeline->fps_n <= 0) {
+    return 0;
+  }
+
+  if (gst_avsynctest_timeline_counts_frames (timeline)) {
+    return frame / timeline->interval_frames;
+  }
+
+  // exact, the steps only guard against rounding
+  guint64 k = gst_util_uint64_scale (frame, (guint64) timeline->fps_d * GST_SECOND, timeline->fps_n) / timeline->interval;
+  while (k > 0 && gst_avsynctest_timeline_sync_frame (timeline, k) > frame) {
+    k--;
+  }
+  while (gst_avsynctest_timeline_sync_frame (timeline, k + 1) <= frame) {
+    k++;
+  }
+
+  return k;
+}
+
+/* index of the sample sync-point k is marked at */
+guint64
+gst_avsynctest_timeline_sync_sample (const GstAvSyncTestTimeline * timeline, guint64 k, gint rate)
+{
+  if (timeline->fps_n <= 0) {
+    return gst_util_uint64_scale_round (k * timeline->interval, rate, GST_SECOND);
+  }
+
+  guint64 frame = gst_avsynctest_timeline_sync_frame (timeline, k);
+  return gst_util_uint64_scale_round (frame, (guint64) timeline->fps_d * rate, timeline->fps_n);
+}
+
+/* the last sync-point marked at or before sample */
+guint64
+gst_avsynctest_timeline_sync_point_at (const GstAvSyncTestTimeline * timeline, guint64 sample, gint rate)
+{
+  GstClockTime period = timeline->interval;
+  if (gst_avsynctest_timeline_counts_frames (timeline)) {
+    period = MAX (gst_util_uint64_scale (timeline->interval_frames, (guint64) timeline->fps_d * GST_SECOND, timeline->fps_n), 1);
+  }
+
+  // sync-point k is marked within the frame after k * interval, so this is at most a step off
+  guint64 k = gst_util_uint64_scale (sample, GST_SECOND, rate) / period;
+  while (k > 0 && gst_avsynctest_timeline_sync_sample (timeline, k, rate) > sample) {
+    k--;
+  }
+  while (gst_avsynctest_timeline_sync_sample (timeline, k + 1, rate) <= sample) {
+    k++;
+  }
+
+  return k;
+}
+
+/* frames from the first to the second marker of a sync-point */
+static guint64
+gst_avsynctest_timeline_marker_gap (const GstAvSyncTestTimeline * timeline)
+{
+  // at least one frame without flash in between, so the two flashes can be told apart
+  guint64 gap = gst_util_uint64_scale_ceil (GST_AV_SYNC_TEST_MARKER_GAP, timeline->fps_n, (guint64) timeline->fps_d * GST_SECOND);
+  return MAX (gap, 2);
+}
+
+/* frame of the second marker of sync-point k */
+guint64
+gst_avsynctest_timeline_second_frame (const GstAvSyncTestTimeline * timeline, guint64 k)
+{
+  if (timeline->fps_n <= 0) {
+    return 0;
+  }
+
+  return gst_avsynctest_timeline_sync_frame (timeline, k) + gst_avsynctest_timeline_marker_gap (timeline);
+}
+
+/*
+ * Whether sync-point k is followed by a second marker. It is left out when
+ * it would not fit before the next sync-point, so the markers of two
+ * sync-points never interleave.
+ */
+gboolean
+gst_avsynctest_timeline_has_second_marker (const GstAvSyncTestTimeline * timeline, guint64 k)
+{
+  switch (timeline->pattern) {
+    case GST_AV_SYNC_TEST_SYNC_PATTERN_DOUBLE:
+      break;
+
+    case GST_AV_SYNC_TEST_SYNC_PATTERN_PSEUDO_RANDOM:
+    {
+      guint bit = k % PSEUDO_RANDOM_PERIOD;
+      if (!((pseudo_random_bits[bit / 8] >> (bit % 8)) & 1)) {
+        return FALSE;
+      }
+      break;
+    }
+
+    default:
+      return FALSE;
+  }
+
+  if (timeline->fps_n <= 0) {
+    return GST_AV_SYNC_TEST_MARKER_GAP < timeline->interval;
+  }
+
+  return gst_avsynctest_timeline_second_frame (timeline, k) < gst_avsynctest_timeline_sync_frame (timeline, k + 1);
+}
+
+guint64
+gst_avsynctest_timeline_second_sample (const GstAvSyncTestTimeline * timeline, guint64 k, gint rate)
+{
+  if (timeline->fps_n <= 0) {
+    return gst_util_uint64_scale_round (k * timeline->interval + GST_AV_SYNC_TEST_MARKER_GAP, rate, GST_SECOND);
+  }
+
+  guint64 frame = gst_avsynctest_timeline_second_frame (timeline, k);
+  return gst_util_uint64_scale_round (frame, (guint64) timeline->fps_d * rate, timeline->fps_n);
+}
+
+/* whether frame shows the first marker of a sync-point */
+gboolean
+gst_avsynctest_timeline_is_sync_frame (const GstAvSyncTestTimeline * timeline, guint64 frame)
+{
+  guint64 k = gst_avsynctest_timeline_sync_point_at_frame (timeline, frame);
+  return gst_avsynctest_timeline_sync_frame (timeline, k) == frame;
+}
+
+/* whether frame shows any marker, in constant time */
+gboolean
+gst_avsynctest_timeline_is_marker_frame (const GstAvSyncTestTimeline * timeline, guint64 frame)
+{
+  guint64 k = gst_avsynctest_timeline_sync_point_at_frame (timeline, frame);
+  if (gst_avsynctest_timeline_sync_frame (timeline, k) == frame) {
+    return TRUE;
+  }
+
+  return gst_avsynctest_timeline_has_second_marker (timeline, k) &&
+      gst_avsynctest_timeline_second_frame (timeline, k) == frame;
+}
+
+static guint64
+gst_avsynctest_gcd (guint64 a, guint64 b)
+{
+  while (b != 0) {
+    guint64 t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/*
+ * Number of frames after which the markers repeat, or 0 when that is
+ * longer than GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH and every frame has to
+ * be looked up with gst_avsynctest_timeline_is_marker_frame().
+ */
+gint
+gst_avsynctest_timeline_schedule_length (const GstAvSyncTestTimeline * timeline)
+{
+  if (timeline->fps_n <= 0) {
+    return 1;
+  }
+
+  // sync-points until the first one falls onto the start of a frame again
+  guint64 sync_points = 1;
+  if (!gst_avsynctest_timeline_counts_frames (timeline)) {
+    guint64 denominator = (guint64) timeline->fps_d * GST_SECOND;
+    denominator /= gst_avsynctest_gcd (timeline->interval, denominator);
+    sync_points = denominator / gst_avsynctest_gcd (timeline->fps_n, denominator);
+  }
+
+  if (timeline->pattern == GST_AV_SYNC_TEST_SYNC_PATTERN_PSEUDO_RANDOM) {
+    sync_points *= PSEUDO_RANDOM_PERIOD / gst_avsynctest_gcd (sync_points, PSEUDO_RANDOM_PERIOD);
+  }
+
+  if (sync_points > GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH) {
+    return 0;
+  }
+
+  guint64 length = gst_avsynctest_timeline_sync_frame (timeline, sync_points);
+  if (length == 0 || length > GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH) {
+    return 0;
+  }
+
+  return (gint) length;
+}
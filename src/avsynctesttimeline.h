@@ -0,0 +1,82 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_TIMELINE_H_
+#define _GST_AV_SYNC_TEST_TIMELINE_H_
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* markers shown at every sync-point */
+typedef enum
+{
+  /* one flash and one beep */
+  GST_AV_SYNC_TEST_SYNC_PATTERN_SINGLE,
+  /* a second flash and beep follow the first one */
+  GST_AV_SYNC_TEST_SYNC_PATTERN_DOUBLE,
+  /* single or double, following a pseudo-random sequence of 127 sync-points */
+  GST_AV_SYNC_TEST_SYNC_PATTERN_PSEUDO_RANDOM,
+} GstAvSyncTestSyncPattern;
+
+#define GST_TYPE_AV_SYNC_TEST_SYNC_PATTERN (gst_avsynctest_sync_pattern_get_type ())
+GType gst_avsynctest_sync_pattern_get_type (void);
+
+/* the second marker follows at least this long and two frames after the first one */
+#define GST_AV_SYNC_TEST_MARKER_GAP (GST_SECOND / 5)
+
+/* longest schedule, in frames, that is kept as a table instead of computed per frame */
+#define GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH (1 << 18)
+
+/*
+ * The timeline both sources derive their sync-points from. Sync-point k
+ * is shown on the first frame at or after k * interval, and the audio
+ * marks it at the sample matching the PTS of that frame. With
+ * interval_frames it is shown on frame k * interval_frames instead.
+ * Without a framerate sync-point k is at k * interval exactly.
+ */
+typedef struct _GstAvSyncTestTimeline
+{
+  /* framerate of the video, 0/1 when there is none */
+  gint fps_n, fps_d;
+
+  /* time between sync-points, and the frames between them overriding it when not 0 */
+  GstClockTime interval;
+  guint interval_frames;
+
+  GstAvSyncTestSyncPattern pattern;
+} GstAvSyncTestTimeline;
+
+void gst_avsynctest_timeline_init (GstAvSyncTestTimeline * timeline, gint fps_n, gint fps_d,
+    GstClockTime interval, guint interval_frames, GstAvSyncTestSyncPattern pattern);
+
+guint64 gst_avsynctest_timeline_sync_frame (const GstAvSyncTestTimeline * timeline, guint64 k);
+guint64 gst_avsynctest_timeline_sync_point_at_frame (const GstAvSyncTestTimeline * timeline, guint64 frame);
+guint64 gst_avsynctest_timeline_sync_sample (const GstAvSyncTestTimeline * timeline, guint64 k, gint rate);
+guint64 gst_avsynctest_timeline_sync_point_at (const GstAvSyncTestTimeline * timeline, guint64 sample, gint rate);
+
+gboolean gst_avsynctest_timeline_has_second_marker (const GstAvSyncTestTimeline * timeline, guint64 k);
+guint64 gst_avsynctest_timeline_second_frame (const GstAvSyncTestTimeline * timeline, guint64 k);
+guint64 gst_avsynctest_timeline_second_sample (const GstAvSyncTestTimeline * timeline, guint64 k, gint rate);
+
+gboolean gst_avsynctest_timeline_is_sync_frame (const GstAvSyncTestTimeline * timeline, guint64 frame);
+gboolean gst_avsynctest_timeline_is_marker_frame (const GstAvSyncTestTimeline * timeline, guint64 frame);
+gint gst_avsynctest_timeline_schedule_length (const GstAvSyncTestTimeline * timeline);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_TIMELINE_H_
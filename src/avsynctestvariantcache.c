@@ -0,0 +1,256 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include "avsynctestvariantcache.h"
+
+/* the variant store, shared by all instances in the process */
+static GMutex store_lock;
+static GCond store_cond;
+static GList *store_entries;
+
+static void
+gst_avsynctest_variant_entry_free (GstAvSyncTestVariantEntry * entry)
+{
+  // an entry of the store may be dropped before it was ever published
+  if (entry->frame_variants != NULL) {
+    g_ptr_array_unref (entry->frame_variants);
+    g_ptr_array_unref (entry->variant_coverage);
+  }
+  g_free (entry->variant_regions);
+  g_free (entry);
+}
+
+static gsize
+gst_avsynctest_variant_size (GPtrArray * frame_variants, GPtrArray * variant_coverage)
+{
+  gsize size = 0;
+  for (guint i = 0; i < frame_variants->len; i++) {
+    size += gst_buffer_get_size (g_ptr_array_index (frame_variants, i));
+    size += gst_buffer_get_size (g_ptr_array_index (variant_coverage, i));
+  }
+
+  return size;
+}
+
+/* takes a reference on frame_variants and variant_coverage and copies the rest */
+static void
+gst_avsynctest_variant_entry_fill (GstAvSyncTestVariantEntry * entry,
+    GPtrArray * frame_variants, GPtrArray * variant_coverage, const GstAvSyncTestDirtyRegion * variant_regions)
+{
+  entry->frame_variants = g_ptr_array_ref (frame_variants);
+  entry->variant_coverage = g_ptr_array_ref (variant_coverage);
+  entry->variant_regions = g_new (GstAvSyncTestDirtyRegion, frame_variants->len);
+  memcpy (entry->variant_regions, variant_regions, sizeof (GstAvSyncTestDirtyRegion) * frame_variants->len);
+  entry->size = gst_avsynctest_variant_size (frame_variants, variant_coverage);
+}
+
+static gboolean
+gst_avsynctest_variant_key_equal (const GstAvSyncTestVariantKey * a, const GstAvSyncTestVariantKey * b)
+{
+  return a->foreground_color == b->foreground_color &&
+      a->background_color == b->background_color &&
+      a->rasterizer == b->rasterizer &&
+      gst_video_info_is_equal (&a->video_info, &b->video_info);
+}
+
+/* drops the least recently used entries until the cache fits into the budget */
+static void
+gst_avsynctest_variant_cache_evict (GstAvSyncTestVariantCache * cache)
+{
+  while (cache->size > cache->budget) {
+    GstAvSyncTestVariantEntry *entry = g_queue_pop_tail (&cache->entries);
+    cache->size -= entry->size;
+    gst_avsynctest_variant_entry_free (entry);
+  }
+}
+
+void
+gst_avsynctest_variant_cache_init (GstAvSyncTestVariantCache * cache, gsize budget)
+{
+  g_queue_init (&cache->entries);
+  cache->size = 0;
+  cache->budget = budget;
+  cache->hits = 0;
+  cache->misses = 0;
+}
+
+void
+gst_avsynctest_variant_cache_clear (GstAvSyncTestVariantCache * cache)
+{
+  g_queue_clear_full (&cache->entries, (GDestroyNotify) gst_avsynctest_variant_entry_free);
+  cache->size = 0;
+}
+
+void
+gst_avsynctest_variant_cache_set_budget (GstAvSyncTestVariantCache * cache, gsize budget)
+{
+  cache->budget = budget;
+  gst_avsynctest_variant_cache_evict (cache);
+}
+
+/* returns the entry for key and marks it as most recently used, or NULL */
+const GstAvSyncTestVariantEntry *
+gst_avsynctest_variant_cache_lookup (GstAvSyncTestVariantCache * cache, const GstAvSyncTestVariantKey * key)
+{
+  for (GList *link = cache->entries.head; link != NULL; link = link->next) {
+    GstAvSyncTestVariantEntry *entry = link->data;
+    if (!gst_avsynctest_variant_key_equal (&entry->key, key)) {
+      continue;
+    }
+
+    g_queue_unlink (&cache->entries, link);
+    g_queue_push_head_link (&cache->entries, link);
+    cache->hits++;
+    return entry;
+  }
+
+  cache->misses++;
+  return NULL;
+}
+
+/*
+ * Take a reference on frame_variants and variant_coverage and copy the
+ * rest. Variants larger than the whole budget are not cached at all.
+ */
+void
+gst_avsynctest_variant_cache_insert (GstAvSyncTestVariantCache * cache, const GstAvSyncTestVariantKey * key,
+    GPtrArray * frame_variants, GPtrArray * variant_coverage, const GstAvSyncTestDirtyRegion * variant_regions)
+{
+  if (gst_avsynctest_variant_size (frame_variants, variant_coverage) > cache->budget) {
+    return;
+  }
+
+  GstAvSyncTestVariantEntry *entry = g_new0 (GstAvSyncTestVariantEntry, 1);
+  entry->key = *key;
+  gst_avsynctest_variant_entry_fill (entry, frame_variants, variant_coverage, variant_regions);
+
+  g_queue_push_head (&cache->entries, entry);
+  cache->size += entry->size;
+  gst_avsynctest_variant_cache_evict (cache);
+}
+
+/*
+ * Returns the entry of the store for key with a use taken on it. When
+ * ready is FALSE the caller is the first user and has to publish or
+ * abandon the entry, otherwise they are published and may be taken from the entry.
+ */
+GstAvSyncTestVariantEntry *
+gst_avsynctest_variant_store_acquire (const GstAvSyncTestVariantKey * key, gboolean * ready)
+{
+  g_mutex_lock (&store_lock);
+
+  GstAvSyncTestVariantEntry *entry;
+  for (;;) {
+    entry = NULL;
+    for (GList *link = store_entries; link != NULL; link = link->next) {
+      if (gst_avsynctest_variant_key_equal (&((GstAvSyncTestVariantEntry *) link->data)->key, key)) {
+        entry = link->data;
+        break;
+      }
+    }
+
+    if (entry == NULL) {
+      entry = g_new0 (GstAvSyncTestVariantEntry, 1);
+      entry->key = *key;
+      entry->users = 1;
+      store_entries = g_list_prepend (store_entries, entry);
+
+      g_mutex_unlock (&store_lock);
+      *ready = FALSE;
+      return entry;
+    }
+
+    entry->users++;
+    while (!entry->ready && !entry->abandoned) {
+      g_cond_wait (&store_cond, &store_lock);
+    }
+
+    if (!entry->abandoned) {
+      break;
+    }
+
+    // it is no longer in the store, the first instance to look the key up again renders it
+    entry->users--;
+    if (entry->users == 0) {
+      gst_avsynctest_variant_entry_free (entry);
+    }
+  }
+
+  g_mutex_unlock (&store_lock);
+  *ready = TRUE;
+  return entry;
+}
+
+/* fills an entry acquired as not ready and wakes the instances waiting for it */
+void
+gst_avsynctest_variant_store_publish (GstAvSyncTestVariantEntry * entry,
+    GPtrArray * frame_variants, GPtrArray * variant_coverage, const GstAvSyncTestDirtyRegion * variant_regions)
+{
+  g_mutex_lock (&store_lock);
+  gst_avsynctest_variant_entry_fill (entry, frame_variants, variant_coverage, variant_regions);
+  entry->ready = TRUE;
+  g_cond_broadcast (&store_cond);
+  g_mutex_unlock (&store_lock);
+}
+
+/*
+ * gives up an entry acquired as not ready without publishing it, and drops
+ * the use taken on it. The instances waiting for it are woken up and acquire
+ * the key again.
+ */
+void
+gst_avsynctest_variant_store_abandon (GstAvSyncTestVariantEntry * entry)
+{
+  g_mutex_lock (&store_lock);
+
+  g_assert (!entry->ready);
+  entry->abandoned = TRUE;
+  store_entries = g_list_remove (store_entries, entry);
+  g_cond_broadcast (&store_cond);
+
+  entry->users--;
+  gboolean unused = entry->users == 0;
+  g_mutex_unlock (&store_lock);
+
+  if (unused) {
+    gst_avsynctest_variant_entry_free (entry);
+  }
+}
+
+void
+gst_avsynctest_variant_store_release (GstAvSyncTestVariantEntry * entry)
+{
+  g_mutex_lock (&store_lock);
+
+  entry->users--;
+  if (entry->users > 0) {
+    g_mutex_unlock (&store_lock);
+    return;
+  }
+
+  store_entries = g_list_remove (store_entries, entry);
+  g_mutex_unlock (&store_lock);
+
+  gst_avsynctest_variant_entry_free (entry);
+}
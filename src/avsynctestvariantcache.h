@@ -0,0 +1,95 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TEST_VARIANT_CACHE_H_
+#define _GST_AV_SYNC_TEST_VARIANT_CACHE_H_
+
+#include <gst/video/video.h>
+
+#include "avsynctestrender.h"
+
+G_BEGIN_DECLS
+
+/* everything the pre-rendered frame variants depend on */
+typedef struct _GstAvSyncTestVariantKey
+{
+  GstVideoInfo video_info;
+  guint foreground_color;
+  guint background_color;
+  gint rasterizer;
+} GstAvSyncTestVariantKey;
+
+/* the frame variants rendered for one key, as set_caps leaves them */
+typedef struct _GstAvSyncTestVariantEntry
+{
+  GstAvSyncTestVariantKey key;
+
+  GPtrArray *frame_variants;
+  GPtrArray *variant_coverage;
+  GstAvSyncTestDirtyRegion *variant_regions;
+
+  /* bytes held by frame_variants and variant_coverage */
+  gsize size;
+
+  /* instances using an entry of the variant store, and whether it is published yet
+   * or was given up by the instance rendering it */
+  gint users;
+  gboolean ready;
+  gboolean abandoned;
+} GstAvSyncTestVariantEntry;
+
+/*
+ * Least-recently-used cache of frame variants, bounded by the bytes of
+ * pixels held. Entries share the buffers with the element, so a hit only
+ * takes references.
+ */
+typedef struct _GstAvSyncTestVariantCache
+{
+  /* most recently used first */
+  GQueue entries;
+  gsize size;
+  gsize budget;
+
+  guint hits;
+  guint misses;
+} GstAvSyncTestVariantCache;
+
+void gst_avsynctest_variant_cache_init (GstAvSyncTestVariantCache * cache, gsize budget);
+void gst_avsynctest_variant_cache_clear (GstAvSyncTestVariantCache * cache);
+void gst_avsynctest_variant_cache_set_budget (GstAvSyncTestVariantCache * cache, gsize budget);
+
+const GstAvSyncTestVariantEntry *gst_avsynctest_variant_cache_lookup (GstAvSyncTestVariantCache * cache, const GstAvSyncTestVariantKey * key);
+void gst_avsynctest_variant_cache_insert (GstAvSyncTestVariantCache * cache, const GstAvSyncTestVariantKey * key,
+    GPtrArray * frame_variants, GPtrArray * variant_coverage, const GstAvSyncTestDirtyRegion * variant_regions);
+
+/*
+ * Process-wide store of the frame variants in use, shared read-only by all
+ * instances with the same key. The first instance acquiring a key renders
+ * the variants and publishes them, instances acquiring it meanwhile wait
+ * for them instead of rendering them again. An entry is dropped when its
+ * last user releases it. When the first instance fails to render them it
+ * abandons the entry, and a waiting instance takes over the rendering.
+ */
+GstAvSyncTestVariantEntry *gst_avsynctest_variant_store_acquire (const GstAvSyncTestVariantKey * key, gboolean * ready);
+void gst_avsynctest_variant_store_publish (GstAvSyncTestVariantEntry * entry,
+    GPtrArray * frame_variants, GPtrArray * variant_coverage, const GstAvSyncTestDirtyRegion * variant_regions);
+void gst_avsynctest_variant_store_abandon (GstAvSyncTestVariantEntry * entry);
+void gst_avsynctest_variant_store_release (GstAvSyncTestVariantEntry * entry);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TEST_VARIANT_CACHE_H_
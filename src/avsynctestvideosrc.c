@@ -22,26 +22,31 @@
 #endif
 
 #include <math.h>
+#include <string.h>
+#include <gst/video/gstvideometa.h>
+#include <gst/video/gstvideopool.h>
 #include "avsynctestvideosrc.h"
+#include "avsynctestframepool.h"
+#include "avsynctestencoder.h"
+#include "avsynctestmeta.h"
+#include "avsynctesttimecode.h"
 
 /* pad templates */
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
     GST_PAD_ALWAYS,
-    GST_STATIC_CAPS("video/x-raw,format=BGRx,interlace-mode=progressive,multiview-mide=mono,pixel-aspect-ratio=1/1")
+    GST_STATIC_CAPS("video/x-raw,format=" GST_AV_SYNC_TEST_RENDER_FORMATS ",interlace-mode=progressive,multiview-mode=mono,pixel-aspect-ratio=1/1; "
+      GST_AV_SYNC_TEST_ENCODED_CAPS)
 );
 
 GST_DEBUG_CATEGORY_STATIC (gst_avsynctestvideosrc_debug);
 #define GST_CAT_DEFAULT gst_avsynctestvideosrc_debug
 
-#define COLOR_R(x) ((double)((x & 0x00FF0000) >> 16) / 0xFF)
-#define COLOR_G(x) ((double)((x & 0x0000FF00) >>  8) / 0xFF)
-#define COLOR_B(x) ((double)((x & 0x000000FF) >>  0) / 0xFF)
-
 /* signals */
 enum
 {
   SIGNAL_SYNC_POINT,
+  SIGNAL_PULL_SYNC_POINT,
   LAST_SIGNAL
 };
 
@@ -54,6 +59,17 @@ enum
   PROP_0,
   PROP_FOREGROUND_COLOR,
   PROP_BACKGROUND_COLOR,
+  PROP_ZERO_COPY,
+  PROP_DIRTY_REGIONS,
+  PROP_EMIT_SIGNALS,
+  PROP_N_THREADS,
+  PROP_RASTERIZER,
+  PROP_VARIANT_CACHE_SIZE,
+  PROP_IS_LIVE,
+  PROP_TIMECODE,
+  PROP_SYNC_INTERVAL,
+  PROP_SYNC_INTERVAL_FRAMES,
+  PROP_SYNC_PATTERN,
 };
 
 /* basic geom types */
@@ -66,13 +82,67 @@ typedef struct rectangle
 } double_rectangle_t;
 
 /* geometry of test-card */
-static const double_rectangle_t flash_rectangle    = {.left=0.07, .top=0.1, .width=0.4,  .height=0.3};
+static const double_rectangle_t flash_rectangle    = {
+  .left=GST_AV_SYNC_TEST_FLASH_LEFT, .top=GST_AV_SYNC_TEST_FLASH_TOP,
+  .width=GST_AV_SYNC_TEST_FLASH_WIDTH, .height=GST_AV_SYNC_TEST_FLASH_HEIGHT
+};
 static const double_rectangle_t amboss_rectangle   = {.left=0.75, .top=0.1, .width=0.05, .height=0.4};
 static const double_rectangle_t timeline_rectangle = {.left=0.04,  .top=0.75, .width=0.9, .height=0.1};
 
 /* property defaults */
 #define PROP_FOREGROUND_COLOR_DEFAULT (0xFFFFFFFF)
 #define PROP_BACKGROUND_COLOR_DEFAULT (0xFF000000)
+#define PROP_ZERO_COPY_DEFAULT (FALSE)
+#define PROP_EMIT_SIGNALS_DEFAULT (TRUE)
+#define PROP_DIRTY_REGIONS_DEFAULT (FALSE)
+#define PROP_N_THREADS_DEFAULT (1)
+#define PROP_RASTERIZER_DEFAULT (GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_BUILTIN)
+#define PROP_VARIANT_CACHE_SIZE_DEFAULT (128 * 1024 * 1024)
+#define PROP_IS_LIVE_DEFAULT (TRUE)
+#define PROP_TIMECODE_DEFAULT (FALSE)
+#define PROP_SYNC_INTERVAL_DEFAULT (GST_SECOND)
+#define PROP_SYNC_INTERVAL_FRAMES_DEFAULT (0)
+#define PROP_SYNC_PATTERN_DEFAULT (GST_AV_SYNC_TEST_SYNC_PATTERN_SINGLE)
+
+/* stroke-width of all lines of the test-card, the default of cairo */
+#define LINE_WIDTH (2.0)
+
+/* ticks of the timeline closer than this merge into a bar and are thinned out */
+#define MIN_TICK_SPACING (4.0 * LINE_WIDTH)
+/* labels are at least this many label-widths apart */
+#define LABEL_SPACING (1.5)
+
+#define GST_TYPE_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER (gst_avsynctestvideosrc_rasterizer_get_type ())
+static GType
+gst_avsynctestvideosrc_rasterizer_get_type (void)
+{
+  static GType rasterizer_type = 0;
+  static const GEnumValue rasterizer_types[] = {
+    {GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_BUILTIN, "Built-in Rasterizer and Bitmap-Digits", "builtin"},
+    {GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_CAIRO, "Cairo, when available at build-time", "cairo"},
+    {0, NULL, NULL},
+  };
+
+  if (!rasterizer_type) {
+    rasterizer_type = g_enum_register_static ("GstAvSyncTestVideoSrcRasterizer", rasterizer_types);
+  }
+  return rasterizer_type;
+}
+
+/* slices with fewer rows are not worth waking a worker-thread for */
+#define MIN_SLICE_ROWS (64)
+
+/* remembers which variant of which generation a recycled buffer was filled with */
+static GQuark variant_tag_quark;
+#define VARIANT_TAG(generation, variant_idx) (((generation) << 8) | (variant_idx))
+
+/* pre-rendered frame variants */
+enum
+{
+  FRAME_VARIANT_BACKGROUND,
+  FRAME_VARIANT_FLASH,
+  N_FRAME_VARIANTS
+};
 
 
 /* parent class */
@@ -85,16 +155,38 @@ static void gst_avsynctestvideosrc_get_property (GObject * object, guint prop_id
 static void gst_avsynctestvideosrc_finalize (GObject * obj);
 
 /* GstBaseSrc member methods */
+static GstCaps *gst_avsynctestvideosrc_get_caps (GstBaseSrc * base, GstCaps * filter);
 static gboolean gst_avsynctestvideosrc_set_caps (GstBaseSrc * base, GstCaps * caps);
 static GstCaps *gst_avsynctestvideosrc_fixate (GstBaseSrc * base, GstCaps * caps);
 static void gst_avsynctestvideosrc_get_times (GstBaseSrc * base, GstBuffer * buffer, GstClockTime * start, GstClockTime * end);
+static gboolean gst_avsynctestvideosrc_decide_allocation (GstBaseSrc * base, GstQuery * query);
+static gboolean gst_avsynctestvideosrc_is_seekable (GstBaseSrc * base);
+static gboolean gst_avsynctestvideosrc_do_seek (GstBaseSrc * base, GstSegment * segment);
+static GstFlowReturn gst_avsynctestvideosrc_create (GstBaseSrc * base, guint64 offset, guint length, GstBuffer ** buffer);
 
 /* GstPushSrc member methods */
 static GstFlowReturn gst_avsynctestvideosrc_fill (GstPushSrc * base, GstBuffer *buffer);
 
 /* GstAvSyncTestVideoSrc member methods */
-static void gst_avsynctestvideosrc_destory_cairo (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_snapshot_colors (GstAvSyncTestVideoSrc * avsynctestvideosrc, guint * foreground_color, guint * background_color);
+static void gst_avsynctestvideosrc_destroy_canvas (GstAvSyncTestVideoSrc * avsynctestvideosrc);
 static void gst_avsynctestvideosrc_paint_background (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_render_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc, guint foreground_color, guint background_color);
+static gboolean gst_avsynctestvideosrc_lookup_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc, guint foreground_color, guint background_color);
+static void gst_avsynctestvideosrc_cache_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_take_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc, const GstAvSyncTestVariantEntry * entry);
+static gboolean gst_avsynctestvideosrc_acquire_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc, guint foreground_color, guint background_color);
+static void gst_avsynctestvideosrc_publish_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_free_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_destroy_frame_pool (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_destroy_slice_runner (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_build_schedule (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static gboolean gst_avsynctestvideosrc_encode_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static void gst_avsynctestvideosrc_free_encoded (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static gboolean gst_avsynctestvideosrc_start_encode (GstAvSyncTestVideoSrc * avsynctestvideosrc);
+static GPtrArray *gst_avsynctestvideosrc_join_encode (GstAvSyncTestVideoSrc * avsynctestvideosrc, guint * generation);
+static void gst_avsynctestvideosrc_seek_frames (GstAvSyncTestVideoSrc * avsynctestvideosrc, GstClockTime position);
+static GstStructure *gst_avsynctestvideosrc_pull_sync_point (GstAvSyncTestVideoSrc * avsynctestvideosrc);
 
 static void
 gst_avsynctestvideosrc_class_init (GstAvSyncTestVideoSrcClass * klass)
@@ -111,14 +203,94 @@ gst_avsynctestvideosrc_class_init (GstAvSyncTestVideoSrcClass * klass)
           "Foreground Color of the generated Test-Image. (big-endian ARGB)",
           0, G_MAXUINT,
           PROP_FOREGROUND_COLOR_DEFAULT,
-          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE));
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
 
   g_object_class_install_property (gobject_class, PROP_BACKGROUND_COLOR,
       g_param_spec_uint ("background-color", "Background-Color",
           "Background Color of the generated Test-Image. (big-endian ARGB)",
           0, G_MAXUINT,
           PROP_BACKGROUND_COLOR_DEFAULT,
-          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE));
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE | GST_PARAM_MUTABLE_PLAYING));
+
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero-Copy",
+          "Push read-only Buffers sharing the Memory of the pre-rendered Frames instead of copying them. "
+          "Downstream Elements writing into the Buffers will get a private copy.",
+          PROP_ZERO_COPY_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DIRTY_REGIONS,
+      g_param_spec_boolean ("dirty-regions", "Dirty-Regions",
+          "Only rewrite the Regions that changed since a recycled Buffer was last filled. "
+          "Must not be enabled when downstream Elements modify the Buffers in-place.",
+          PROP_DIRTY_REGIONS_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_EMIT_SIGNALS,
+      g_param_spec_boolean ("emit-signals", "Emit-Signals",
+          "Emit the sync-point Signal on the Streaming-Thread. "
+          "The Sync-Points drained by the pull-sync-point Action-Signal are queued regardless.",
+          PROP_EMIT_SIGNALS_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "N-Threads",
+          "Number of Threads the Frames are rendered and copied with, in horizontal Slices. "
+          "0 uses one Thread per Processor.",
+          0, G_MAXINT,
+          PROP_N_THREADS_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_RASTERIZER,
+      g_param_spec_enum ("rasterizer", "Rasterizer",
+          "Rasterizer the Test-Card is painted with. "
+          "Falls back to the built-in one when built without cairo.",
+          GST_TYPE_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER,
+          PROP_RASTERIZER_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_VARIANT_CACHE_SIZE,
+      g_param_spec_uint64 ("variant-cache-size", "Variant-Cache-Size",
+          "Bytes of pre-rendered Frames kept for recently negotiated Caps and Colors, "
+          "so switching back to them needs no rendering. Applied on the next Caps. 0 disables the Cache.",
+          0, G_MAXUINT64,
+          PROP_VARIANT_CACHE_SIZE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_IS_LIVE,
+      g_param_spec_boolean ("is-live", "Is-Live",
+          "Push Frames paced by the Clock. When disabled, Frames are generated as fast as Downstream accepts them.",
+          PROP_IS_LIVE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_TIMECODE,
+      g_param_spec_boolean ("timecode", "Timecode",
+          "Carry the Frame-Number as machine-readable Band below the Timeline in every Frame, read by avsynctimecodereader. "
+          "Not available for encoded Caps, disables zero-copy.",
+          PROP_TIMECODE_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync-Interval",
+          "Time between two Sync-Points in ns. Each is shown on the first Frame at or after its Time.",
+          GST_MSECOND, 3600 * GST_SECOND,
+          PROP_SYNC_INTERVAL_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL_FRAMES,
+      g_param_spec_uint ("sync-interval-frames", "Sync-Interval-Frames",
+          "Frames between two Sync-Points, overrides sync-interval when not 0.",
+          0, G_MAXINT,
+          PROP_SYNC_INTERVAL_FRAMES_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
+
+  g_object_class_install_property (gobject_class, PROP_SYNC_PATTERN,
+      g_param_spec_enum ("sync-pattern", "Sync-Pattern",
+          "Flashes shown at every Sync-Point. The second Flash follows after 200 ms and at least two Frames, "
+          "when it fits before the next Sync-Point.",
+          GST_TYPE_AV_SYNC_TEST_SYNC_PATTERN,
+          PROP_SYNC_PATTERN_DEFAULT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_MUTABLE_READY));
 
 
   gst_av_sync_test_video_src_signals[SIGNAL_SYNC_POINT] = g_signal_new (
@@ -130,20 +302,41 @@ gst_avsynctestvideosrc_class_init (GstAvSyncTestVideoSrcClass * klass)
     /* accu_data */ NULL,
     /* c_marshaller */ NULL,
     /* return_type */   G_TYPE_NONE,
+    /* n_params */ 3,
+    /* varargs: param types */ G_TYPE_UINT64, G_TYPE_UINT64, G_TYPE_UINT64);
+
+  gst_av_sync_test_video_src_signals[SIGNAL_PULL_SYNC_POINT] = g_signal_new (
+    /* signal_name */ "pull-sync-point",
+    /* itype */ G_TYPE_FROM_CLASS (klass),
+    /* signal_flags */ G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+    /* class_offset */ G_STRUCT_OFFSET (GstAvSyncTestVideoSrcClass, pull_sync_point),
+    /* accumulator */ NULL,
+    /* accu_data */ NULL,
+    /* c_marshaller */ NULL,
+    /* return_type */   GST_TYPE_STRUCTURE,
     /* n_params */ 0
     /* varargs: param types */);
 
+  klass->pull_sync_point = gst_avsynctestvideosrc_pull_sync_point;
+
 
   GstBaseSrcClass *base_src_class = GST_BASE_SRC_CLASS (klass);
+  base_src_class->get_caps = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_get_caps);
   base_src_class->set_caps = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_set_caps);
   base_src_class->fixate = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_fixate);
   base_src_class->get_times = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_get_times);
+  base_src_class->decide_allocation = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_decide_allocation);
+  base_src_class->is_seekable = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_is_seekable);
+  base_src_class->do_seek = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_do_seek);
+  base_src_class->create = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_create);
 
   GstPushSrcClass *src_class = GST_PUSH_SRC_CLASS (klass);
   src_class->fill = GST_DEBUG_FUNCPTR (gst_avsynctestvideosrc_fill);
 
   GST_DEBUG_CATEGORY_INIT (gst_avsynctestvideosrc_debug, "avsynctestvideosrc", 0, "AV Sync-Test Video Src");
 
+  variant_tag_quark = g_quark_from_static_string ("GstAvSyncTestVideoSrcVariantTag");
+
   gst_element_class_add_static_pad_template (element_class, &srctemplate);
 
   gst_element_class_set_static_metadata (element_class, "AV Sync-Test Video Src",
@@ -159,8 +352,26 @@ gst_avsynctestvideosrc_init (GstAvSyncTestVideoSrc * avsynctestvideosrc)
 
   avsynctestvideosrc->foreground_color = PROP_FOREGROUND_COLOR_DEFAULT;
   avsynctestvideosrc->background_color = PROP_BACKGROUND_COLOR_DEFAULT;
-
-  gst_base_src_set_live(GST_BASE_SRC(avsynctestvideosrc), TRUE);
+  avsynctestvideosrc->zero_copy = PROP_ZERO_COPY_DEFAULT;
+  avsynctestvideosrc->dirty_regions = PROP_DIRTY_REGIONS_DEFAULT;
+  avsynctestvideosrc->emit_signals = PROP_EMIT_SIGNALS_DEFAULT;
+  avsynctestvideosrc->n_threads = PROP_N_THREADS_DEFAULT;
+  avsynctestvideosrc->rasterizer = PROP_RASTERIZER_DEFAULT;
+  avsynctestvideosrc->variant_cache_size = PROP_VARIANT_CACHE_SIZE_DEFAULT;
+  avsynctestvideosrc->seek_position = GST_CLOCK_TIME_NONE;
+  avsynctestvideosrc->timecode = PROP_TIMECODE_DEFAULT;
+  avsynctestvideosrc->sync_interval = PROP_SYNC_INTERVAL_DEFAULT;
+  avsynctestvideosrc->sync_interval_frames = PROP_SYNC_INTERVAL_FRAMES_DEFAULT;
+  avsynctestvideosrc->sync_pattern = PROP_SYNC_PATTERN_DEFAULT;
+
+  gst_avsynctest_variant_cache_init (&avsynctestvideosrc->variant_cache, PROP_VARIANT_CACHE_SIZE_DEFAULT);
+
+  gst_avsynctest_sync_ring_init (&avsynctestvideosrc->sync_ring);
+
+  // timestamps are derived from the frame count, running-times from the time segment
+  gst_base_src_set_format (GST_BASE_SRC (avsynctestvideosrc), GST_FORMAT_TIME);
+
+  gst_base_src_set_live(GST_BASE_SRC(avsynctestvideosrc), PROP_IS_LIVE_DEFAULT);
 }
 
 void
@@ -170,11 +381,60 @@ gst_avsynctestvideosrc_set_property (GObject * object, guint property_id, const
 
   switch (property_id) {
     case PROP_FOREGROUND_COLOR:
+      // controlled, so it also changes while the streaming-thread reads it
+      GST_OBJECT_LOCK (avsynctestvideosrc);
       avsynctestvideosrc->foreground_color = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK (avsynctestvideosrc);
       break;
 
     case PROP_BACKGROUND_COLOR:
+      GST_OBJECT_LOCK (avsynctestvideosrc);
       avsynctestvideosrc->background_color = g_value_get_uint(value);
+      GST_OBJECT_UNLOCK (avsynctestvideosrc);
+      break;
+
+    case PROP_ZERO_COPY:
+      avsynctestvideosrc->zero_copy = g_value_get_boolean(value);
+      break;
+
+    case PROP_DIRTY_REGIONS:
+      avsynctestvideosrc->dirty_regions = g_value_get_boolean(value);
+      break;
+
+    case PROP_EMIT_SIGNALS:
+      avsynctestvideosrc->emit_signals = g_value_get_boolean(value);
+      break;
+
+    case PROP_N_THREADS:
+      avsynctestvideosrc->n_threads = g_value_get_uint(value);
+      break;
+
+    case PROP_RASTERIZER:
+      avsynctestvideosrc->rasterizer = g_value_get_enum(value);
+      break;
+
+    case PROP_VARIANT_CACHE_SIZE:
+      avsynctestvideosrc->variant_cache_size = g_value_get_uint64(value);
+      break;
+
+    case PROP_IS_LIVE:
+      gst_base_src_set_live (GST_BASE_SRC (avsynctestvideosrc), g_value_get_boolean(value));
+      break;
+
+    case PROP_TIMECODE:
+      avsynctestvideosrc->timecode = g_value_get_boolean(value);
+      break;
+
+    case PROP_SYNC_INTERVAL:
+      avsynctestvideosrc->sync_interval = g_value_get_uint64(value);
+      break;
+
+    case PROP_SYNC_INTERVAL_FRAMES:
+      avsynctestvideosrc->sync_interval_frames = g_value_get_uint(value);
+      break;
+
+    case PROP_SYNC_PATTERN:
+      avsynctestvideosrc->sync_pattern = g_value_get_enum(value);
       break;
 
 
@@ -191,11 +451,59 @@ gst_avsynctestvideosrc_get_property (GObject * object, guint property_id, GValue
 
   switch (property_id) {
     case PROP_FOREGROUND_COLOR:
+      GST_OBJECT_LOCK (avsynctestvideosrc);
       g_value_set_uint (value, avsynctestvideosrc->foreground_color);
+      GST_OBJECT_UNLOCK (avsynctestvideosrc);
       break;
 
     case PROP_BACKGROUND_COLOR:
+      GST_OBJECT_LOCK (avsynctestvideosrc);
       g_value_set_uint (value, avsynctestvideosrc->background_color);
+      GST_OBJECT_UNLOCK (avsynctestvideosrc);
+      break;
+
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, avsynctestvideosrc->zero_copy);
+      break;
+
+    case PROP_DIRTY_REGIONS:
+      g_value_set_boolean (value, avsynctestvideosrc->dirty_regions);
+      break;
+
+    case PROP_EMIT_SIGNALS:
+      g_value_set_boolean (value, avsynctestvideosrc->emit_signals);
+      break;
+
+    case PROP_N_THREADS:
+      g_value_set_uint (value, avsynctestvideosrc->n_threads);
+      break;
+
+    case PROP_RASTERIZER:
+      g_value_set_enum (value, avsynctestvideosrc->rasterizer);
+      break;
+
+    case PROP_VARIANT_CACHE_SIZE:
+      g_value_set_uint64 (value, avsynctestvideosrc->variant_cache_size);
+      break;
+
+    case PROP_IS_LIVE:
+      g_value_set_boolean (value, gst_base_src_is_live (GST_BASE_SRC (avsynctestvideosrc)));
+      break;
+
+    case PROP_TIMECODE:
+      g_value_set_boolean (value, avsynctestvideosrc->timecode);
+      break;
+
+    case PROP_SYNC_INTERVAL:
+      g_value_set_uint64 (value, avsynctestvideosrc->sync_interval);
+      break;
+
+    case PROP_SYNC_INTERVAL_FRAMES:
+      g_value_set_uint (value, avsynctestvideosrc->sync_interval_frames);
+      break;
+
+    case PROP_SYNC_PATTERN:
+      g_value_set_enum (value, avsynctestvideosrc->sync_pattern);
       break;
 
 
@@ -211,36 +519,291 @@ gst_avsynctestvideosrc_finalize (GObject * object)
   GstAvSyncTestVideoSrc *avsynctestvideosrc = GST_AV_SYNC_TEST_VIDEO_SRC (object);
   GST_DEBUG_OBJECT (avsynctestvideosrc, "finalize");
 
-  gst_avsynctestvideosrc_destory_cairo(avsynctestvideosrc);
+  gst_avsynctestvideosrc_destroy_canvas(avsynctestvideosrc);
+  gst_avsynctestvideosrc_destroy_frame_pool(avsynctestvideosrc);
+  gst_avsynctest_coverage_map_clear(&avsynctestvideosrc->timecode_coverage);
+  gst_avsynctestvideosrc_free_variants(avsynctestvideosrc);
+  gst_avsynctestvideosrc_free_encoded(avsynctestvideosrc);
+  g_free(avsynctestvideosrc->frame_schedule);
+  gst_avsynctest_variant_cache_clear(&avsynctestvideosrc->variant_cache);
+  if (avsynctestvideosrc->shared_variants != NULL) {
+    gst_avsynctest_variant_store_release(avsynctestvideosrc->shared_variants);
+  }
+  gst_avsynctestvideosrc_destroy_slice_runner(avsynctestvideosrc);
+  gst_avsynctest_sync_ring_clear(&avsynctestvideosrc->sync_ring);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-void
-gst_avsynctestvideosrc_create_cairo (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+gboolean
+gst_avsynctestvideosrc_create_canvas (GstAvSyncTestVideoSrc * avsynctestvideosrc)
 {
-  GST_DEBUG_OBJECT (avsynctestvideosrc, "creating cairo surface xRGB");
-  avsynctestvideosrc->surface = cairo_image_surface_create (
-    CAIRO_FORMAT_RGB24,
+  // the test-card is painted as coverage-map and then rendered into the negotiated format
+  GST_DEBUG_OBJECT (avsynctestvideosrc, "creating coverage-map");
+  gst_avsynctest_coverage_map_init (&avsynctestvideosrc->coverage,
     avsynctestvideosrc->video_info.width,
     avsynctestvideosrc->video_info.height);
 
-  GST_DEBUG_OBJECT (avsynctestvideosrc, "creating cairo surface");
-  avsynctestvideosrc->cairo = cairo_create (avsynctestvideosrc->surface);
+#ifdef HAVE_CAIRO
+  if (avsynctestvideosrc->rasterizer == GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_CAIRO) {
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "creating cairo surface A8 on the coverage-map");
+    avsynctestvideosrc->surface = cairo_image_surface_create_for_data (
+      avsynctestvideosrc->coverage.data,
+      CAIRO_FORMAT_A8,
+      avsynctestvideosrc->coverage.width,
+      avsynctestvideosrc->coverage.height,
+      avsynctestvideosrc->coverage.stride);
+
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "creating cairo context");
+    avsynctestvideosrc->cairo = cairo_create (avsynctestvideosrc->surface);
+    avsynctestvideosrc->digit_size = 0;
+
+    cairo_status_t status = cairo_status (avsynctestvideosrc->cairo);
+    if (status != CAIRO_STATUS_SUCCESS) {
+      GST_ERROR_OBJECT (avsynctestvideosrc, "could not create cairo context: %s", cairo_status_to_string (status));
+      return FALSE;
+    }
+  }
+#else
+  if (avsynctestvideosrc->rasterizer == GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_CAIRO) {
+    GST_WARNING_OBJECT (avsynctestvideosrc, "built without cairo, using the built-in rasterizer");
+  }
+#endif
+
+  return TRUE;
 }
 
 void
-gst_avsynctestvideosrc_destory_cairo (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+gst_avsynctestvideosrc_destroy_canvas (GstAvSyncTestVideoSrc * avsynctestvideosrc)
 {
+#ifdef HAVE_CAIRO
   if (avsynctestvideosrc->cairo != NULL) {
     GST_DEBUG_OBJECT (avsynctestvideosrc, "destroying cairo context");
     cairo_destroy(avsynctestvideosrc->cairo);
+    avsynctestvideosrc->cairo = NULL;
   }
 
   if (avsynctestvideosrc->surface != NULL) {
     GST_DEBUG_OBJECT (avsynctestvideosrc, "destroying cairo surface");
     cairo_surface_destroy(avsynctestvideosrc->surface);
+    avsynctestvideosrc->surface = NULL;
+  }
+#endif
+
+  if (avsynctestvideosrc->coverage.data != NULL) {
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "freeing coverage-map");
+    gst_avsynctest_coverage_map_clear (&avsynctestvideosrc->coverage);
+  }
+}
+
+void
+gst_avsynctestvideosrc_free_variants (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  if (avsynctestvideosrc->frame_variants != NULL) {
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "freeing frame variants");
+    g_ptr_array_unref(avsynctestvideosrc->frame_variants);
+    avsynctestvideosrc->frame_variants = NULL;
+  }
+
+  if (avsynctestvideosrc->variant_coverage != NULL) {
+    g_ptr_array_unref(avsynctestvideosrc->variant_coverage);
+    avsynctestvideosrc->variant_coverage = NULL;
+  }
+
+  g_free(avsynctestvideosrc->variant_regions);
+  avsynctestvideosrc->variant_regions = NULL;
+}
+
+void
+gst_avsynctestvideosrc_create_frame_pool (GstAvSyncTestVideoSrc * avsynctestvideosrc, GstCaps * caps)
+{
+  GST_DEBUG_OBJECT (avsynctestvideosrc, "creating frame pool");
+  avsynctestvideosrc->frame_pool = gst_avsynctestframepool_new ();
+
+  GstStructure *config = gst_buffer_pool_get_config (avsynctestvideosrc->frame_pool);
+  gst_buffer_pool_config_set_params (config, caps, 0, 0, 0);
+  gst_buffer_pool_set_config (avsynctestvideosrc->frame_pool, config);
+  gst_buffer_pool_set_active (avsynctestvideosrc->frame_pool, TRUE);
+}
+
+void
+gst_avsynctestvideosrc_destroy_frame_pool (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  if (avsynctestvideosrc->frame_pool != NULL) {
+    // buffers still in flight are freed instead of recycled when they return
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "destroying frame pool");
+    gst_buffer_pool_set_active (avsynctestvideosrc->frame_pool, FALSE);
+    gst_object_unref (avsynctestvideosrc->frame_pool);
+    avsynctestvideosrc->frame_pool = NULL;
+  }
+}
+
+void
+gst_avsynctestvideosrc_create_slice_runner (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  guint n_threads = avsynctestvideosrc->n_threads;
+  if (n_threads == 0) {
+    n_threads = g_get_num_processors ();
+  }
+
+  if (avsynctestvideosrc->slice_runner != NULL && avsynctestvideosrc->slice_runner->n_threads == n_threads) {
+    return;
+  }
+
+  gst_avsynctestvideosrc_destroy_slice_runner(avsynctestvideosrc);
+
+  GST_DEBUG_OBJECT (avsynctestvideosrc, "creating slice runner with %u threads", n_threads);
+  avsynctestvideosrc->slice_runner = gst_avsynctest_slice_runner_new (n_threads);
+}
+
+void
+gst_avsynctestvideosrc_destroy_slice_runner (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  if (avsynctestvideosrc->slice_runner != NULL) {
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "destroying slice runner");
+    gst_avsynctest_slice_runner_free (avsynctestvideosrc->slice_runner);
+    avsynctestvideosrc->slice_runner = NULL;
+  }
+}
+
+/* number of slices a job touching rows rows is split into */
+static guint
+gst_avsynctestvideosrc_n_slices (GstAvSyncTestVideoSrc * avsynctestvideosrc, gint rows)
+{
+  return MAX (1, MIN (avsynctestvideosrc->slice_runner->n_threads, rows / MIN_SLICE_ROWS));
+}
+
+void
+gst_avsynctestvideosrc_free_encoded (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  if (avsynctestvideosrc->encode_thread != NULL) {
+    guint generation;
+    GPtrArray *encoded = gst_avsynctestvideosrc_join_encode (avsynctestvideosrc, &generation);
+    if (encoded != NULL) {
+      g_ptr_array_unref (encoded);
+    }
+  }
+
+  if (avsynctestvideosrc->encoded_frames != NULL) {
+    GST_DEBUG_OBJECT (avsynctestvideosrc, "freeing encoded frames");
+    g_ptr_array_unref(avsynctestvideosrc->encoded_frames);
+    avsynctestvideosrc->encoded_frames = NULL;
+  }
+
+  gst_caps_replace (&avsynctestvideosrc->encoded_caps, NULL);
+}
+
+/* the compressed formats are only offered when an encoder for them is installed */
+static GstCaps *
+gst_avsynctestvideosrc_get_caps (GstBaseSrc * base, GstCaps * filter)
+{
+  GstCaps *caps = gst_pad_get_pad_template_caps (GST_BASE_SRC_PAD (base));
+  caps = gst_caps_make_writable (caps);
+
+  for (gint i = gst_caps_get_size (caps) - 1; i >= 0; i--) {
+    const gchar *media_type = gst_structure_get_name (gst_caps_get_structure (caps, i));
+    if (!g_str_equal (media_type, "video/x-raw") && !gst_avsynctest_encoder_available (media_type)) {
+      gst_caps_remove_structure (caps, i);
+    }
+  }
+
+  if (filter != NULL) {
+    GstCaps *intersection = gst_caps_intersect_full (filter, caps, GST_CAPS_INTERSECT_FIRST);
+    gst_caps_unref (caps);
+    caps = intersection;
   }
+
+  return caps;
+}
+
+/* the video-info of the raw frames, that are rendered for the encoder */
+static gboolean
+gst_avsynctestvideosrc_encoder_video_info (GstCaps * caps, GstVideoInfo * info)
+{
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+  gint width, height, fps_n, fps_d;
+
+  if (!gst_structure_get_int (structure, "width", &width) ||
+      !gst_structure_get_int (structure, "height", &height) ||
+      !gst_structure_get_fraction (structure, "framerate", &fps_n, &fps_d)) {
+    return FALSE;
+  }
+
+  gst_video_info_set_format (info, GST_AV_SYNC_TEST_ENCODER_INPUT_FORMAT, width, height);
+  info->fps_n = fps_n;
+  info->fps_d = fps_d;
+  return TRUE;
+}
+
+/*
+ * Fills the buffers of the downstream pool when there is one. Their rows
+ * may be padded or aligned however downstream wants, as long as each
+ * buffer describes its layout in a GstVideoMeta: fill() maps every buffer
+ * by its meta and copies the variant row by row into any stride.
+ */
+static gboolean
+gst_avsynctestvideosrc_decide_allocation (GstBaseSrc * base, GstQuery * query)
+{
+  GstAvSyncTestVideoSrc *avsynctestvideosrc = GST_AV_SYNC_TEST_VIDEO_SRC (base);
+
+  if (avsynctestvideosrc->encoded_caps != NULL) {
+    // the encoded loop is replayed from its own buffers
+    return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (base, query);
+  }
+
+  GstBufferPool *pool = NULL;
+  guint size, min, max;
+  gboolean update = gst_query_get_n_allocation_pools (query) > 0;
+  if (update) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    size = MAX (size, avsynctestvideosrc->video_info.size);
+  } else {
+    size = avsynctestvideosrc->video_info.size;
+    min = max = 0;
+  }
+
+  if (pool == NULL) {
+    pool = gst_video_buffer_pool_new ();
+  }
+
+  GstCaps *caps;
+  gst_query_parse_allocation (query, &caps, NULL);
+
+  GstStructure *config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+
+  gboolean video_meta = gst_query_find_allocation_meta (query, GST_VIDEO_META_API_TYPE, NULL);
+  if (video_meta) {
+    gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  } else if (gst_buffer_pool_config_has_option (config, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT)) {
+    // without a meta downstream expects the default layout, so no padding can be described
+    GstVideoAlignment align;
+    gst_video_alignment_reset (&align);
+    gst_buffer_pool_config_set_video_alignment (config, &align);
+  }
+
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    // the pool may have adjusted the config, try once more with its proposal
+    config = gst_buffer_pool_get_config (pool);
+    if (!gst_buffer_pool_config_validate_params (config, caps, size, min, max)
+        || !gst_buffer_pool_set_config (pool, config)) {
+      GST_ELEMENT_ERROR (avsynctestvideosrc, RESOURCE, SETTINGS, (NULL), ("could not configure the buffer pool"));
+      gst_object_unref (pool);
+      return FALSE;
+    }
+  }
+
+  GST_DEBUG_OBJECT (avsynctestvideosrc, "filling buffers of %" GST_PTR_FORMAT ", video-meta: %d", pool, video_meta);
+
+  if (update) {
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  } else {
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+  }
+
+  gst_object_unref (pool);
+
+  return GST_BASE_SRC_CLASS (parent_class)->decide_allocation (base, query);
 }
 
 static gboolean
@@ -249,10 +812,79 @@ gst_avsynctestvideosrc_set_caps (GstBaseSrc * base, GstCaps * caps)
   GstAvSyncTestVideoSrc *avsynctestvideosrc = GST_AV_SYNC_TEST_VIDEO_SRC (base);
   GST_DEBUG_OBJECT (avsynctestvideosrc, "set_caps caps=%" GST_PTR_FORMAT, caps);
 
-  gst_video_info_from_caps (&avsynctestvideosrc->video_info, caps);
-  gst_avsynctestvideosrc_destory_cairo(avsynctestvideosrc);
-  gst_avsynctestvideosrc_create_cairo(avsynctestvideosrc);
-  gst_avsynctestvideosrc_paint_background(avsynctestvideosrc);
+  gst_avsynctestvideosrc_free_encoded(avsynctestvideosrc);
+
+  gboolean encoded = !gst_structure_has_name (gst_caps_get_structure (caps, 0), "video/x-raw");
+  if (encoded) {
+    if (!gst_avsynctestvideosrc_encoder_video_info (caps, &avsynctestvideosrc->video_info)) {
+      GST_ERROR_OBJECT (avsynctestvideosrc, "invalid caps %" GST_PTR_FORMAT, caps);
+      return FALSE;
+    }
+
+    avsynctestvideosrc->encoded_caps = gst_caps_ref (caps);
+  } else {
+    gst_video_info_from_caps (&avsynctestvideosrc->video_info, caps);
+  }
+
+  gst_avsynctestvideosrc_create_slice_runner(avsynctestvideosrc);
+
+  guint foreground_color, background_color;
+  gst_avsynctestvideosrc_snapshot_colors(avsynctestvideosrc, &foreground_color, &background_color);
+
+  // instances with the same caps and colors share their variants, the first one renders them
+  if (!gst_avsynctestvideosrc_acquire_variants(avsynctestvideosrc, foreground_color, background_color)) {
+    if (!gst_avsynctestvideosrc_lookup_variants(avsynctestvideosrc, foreground_color, background_color)) {
+      gst_avsynctestvideosrc_destroy_canvas(avsynctestvideosrc);
+      if (!gst_avsynctestvideosrc_create_canvas(avsynctestvideosrc)) {
+        // instances waiting for these variants render them on their own
+        gst_avsynctestvideosrc_destroy_canvas(avsynctestvideosrc);
+        gst_avsynctestvideosrc_free_variants(avsynctestvideosrc);
+        gst_avsynctest_variant_store_abandon(avsynctestvideosrc->shared_variants);
+        avsynctestvideosrc->shared_variants = NULL;
+
+        GST_ELEMENT_ERROR (avsynctestvideosrc, RESOURCE, FAILED, (NULL), ("could not create the canvas"));
+        return FALSE;
+      }
+
+      gst_avsynctestvideosrc_render_variants(avsynctestvideosrc, foreground_color, background_color);
+
+      // the coverage-map is only needed to render the variants, fill() never paints
+      gst_avsynctestvideosrc_destroy_canvas(avsynctestvideosrc);
+
+      gst_avsynctestvideosrc_cache_variants(avsynctestvideosrc);
+    }
+
+    gst_avsynctestvideosrc_publish_variants(avsynctestvideosrc);
+  }
+
+  gst_avsynctestvideosrc_build_schedule(avsynctestvideosrc);
+
+  // after the schedule is known, a predicted loop is seeked onto its start
+  if (GST_CLOCK_TIME_IS_VALID (avsynctestvideosrc->seek_position)) {
+    gst_avsynctestvideosrc_seek_frames(avsynctestvideosrc, avsynctestvideosrc->seek_position);
+  }
+
+  gst_avsynctestvideosrc_destroy_frame_pool(avsynctestvideosrc);
+
+  gst_avsynctest_coverage_map_clear(&avsynctestvideosrc->timecode_coverage);
+
+  if (encoded) {
+    if (avsynctestvideosrc->timecode) {
+      GST_WARNING_OBJECT (avsynctestvideosrc, "the encoded loop can not carry a timecode, sending it without");
+    }
+
+    // the loop is replayed by create(), no raw buffers are ever pushed
+    return gst_avsynctestvideosrc_encode_variants(avsynctestvideosrc);
+  }
+
+  if (avsynctestvideosrc->timecode) {
+    // only the rows of the band are ever painted, the others stay unused
+    gst_avsynctest_coverage_map_init (&avsynctestvideosrc->timecode_coverage,
+      avsynctestvideosrc->video_info.width, avsynctestvideosrc->video_info.height);
+    avsynctestvideosrc->timecode_generation = avsynctestvideosrc->variant_generation - 1;
+  }
+
+  gst_avsynctestvideosrc_create_frame_pool(avsynctestvideosrc, caps);
 
  return TRUE;
 }
@@ -283,6 +915,11 @@ gst_avsynctestvideosrc_get_times (GstBaseSrc * base, GstBuffer * buffer, GstCloc
     GST_TIME_ARGS(GST_BUFFER_PTS (buffer)),
     GST_TIME_ARGS(GST_BUFFER_DURATION (buffer)));
 
+  // only a live source waits for the clock, otherwise frames are pushed as fast as downstream takes them
+  if (!gst_base_src_is_live (base)) {
+    return;
+  }
+
   GstClockTime timestamp = GST_BUFFER_PTS (buffer);
 
   if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
@@ -296,6 +933,67 @@ gst_avsynctestvideosrc_get_times (GstBaseSrc * base, GstBuffer * buffer, GstCloc
   }
 }
 
+/*
+ * moves to the frame at or after position, or defers it until the framerate
+ * is known. Played backwards, it moves to the last frame before position.
+ */
+static void
+gst_avsynctestvideosrc_seek_frames (GstAvSyncTestVideoSrc * src, GstClockTime position)
+{
+  if (src->video_info.fps_n <= 0) {
+    src->n_frames = 0;
+    src->seek_position = position;
+    return;
+  }
+
+  src->n_frames = gst_util_uint64_scale_ceil (position, src->video_info.fps_n, src->video_info.fps_d * GST_SECOND);
+  src->seek_position = GST_CLOCK_TIME_NONE;
+
+  if (src->reverse) {
+    src->n_frames--;
+  }
+
+  // only the first frame of a predicted loop is a keyframe, start decoding there
+  if (src->encoded_caps != NULL && src->n_frames > 0 &&
+      !gst_avsynctest_encoder_is_intra_only (gst_structure_get_name (gst_caps_get_structure (src->encoded_caps, 0)))) {
+    src->n_frames -= src->n_frames % MAX (src->schedule_length, 1);
+  }
+
+  GST_DEBUG_OBJECT (src, "seeked to frame %" G_GINT64_FORMAT, src->n_frames);
+}
+
+static gboolean
+gst_avsynctestvideosrc_is_seekable (GstBaseSrc * base)
+{
+  // every frame derives from its index alone
+  return TRUE;
+}
+
+static gboolean
+gst_avsynctestvideosrc_do_seek (GstBaseSrc * base, GstSegment * segment)
+{
+  GstAvSyncTestVideoSrc *avsynctestvideosrc = GST_AV_SYNC_TEST_VIDEO_SRC (base);
+  GST_DEBUG_OBJECT (avsynctestvideosrc, "do_seek segment=%" GST_SEGMENT_FORMAT, segment);
+
+  // backwards from the stop, which is where the segment position of a reverse seek is
+  if (segment->rate < 0.0 && !GST_CLOCK_TIME_IS_VALID (segment->stop)) {
+    GST_WARNING_OBJECT (avsynctestvideosrc, "reverse playback requires a stop position");
+    return FALSE;
+  }
+
+  if (segment->rate < 0.0 && avsynctestvideosrc->encoded_caps != NULL &&
+      !gst_avsynctest_encoder_is_intra_only (gst_structure_get_name (gst_caps_get_structure (avsynctestvideosrc->encoded_caps, 0)))) {
+    GST_WARNING_OBJECT (avsynctestvideosrc, "predicted frames can not be played backwards");
+    return FALSE;
+  }
+
+  segment->time = segment->start;
+  avsynctestvideosrc->reverse = segment->rate < 0.0;
+  gst_avsynctestvideosrc_seek_frames (avsynctestvideosrc, segment->position);
+
+  return TRUE;
+}
+
 static double_rectangle_t
 gst_avsynctestvideosrc_scale_rectangle(double_rectangle_t rectangle, double width, double height)
 {
@@ -307,211 +1005,1102 @@ gst_avsynctestvideosrc_scale_rectangle(double_rectangle_t rectangle, double widt
   };
 }
 
+/*
+ * Painting primitives of the test-card, dispatched to the built-in
+ * rasterizer or to cairo, which both paint into the same coverage-map.
+ */
+#ifdef HAVE_CAIRO
+#define USE_CAIRO(src) ((src)->cairo != NULL)
+#else
+#define USE_CAIRO(src) (FALSE)
+#endif
+
 static void
-gst_avsynctestvideosrc_paint_background (GstAvSyncTestVideoSrc * src)
+gst_avsynctestvideosrc_paint_erase (GstAvSyncTestVideoSrc * src)
 {
-  cairo_t *cr = src->cairo;
-  double width = cairo_image_surface_get_width (src->surface);
-  double height = cairo_image_surface_get_height (src->surface);
+#ifdef HAVE_CAIRO
+  if (USE_CAIRO (src)) {
+    cairo_set_operator (src->cairo, CAIRO_OPERATOR_CLEAR);
+    cairo_paint (src->cairo);
+    cairo_set_operator (src->cairo, CAIRO_OPERATOR_OVER);
+
+    // continue painting with full coverage, which is rendered in foreground_color
+    cairo_set_source_rgba (src->cairo, 0, 0, 0, 1);
+    cairo_set_line_width (src->cairo, LINE_WIDTH);
+    return;
+  }
+#endif
 
-  // fill background with background_color
-  cairo_rectangle (cr, 0, 0, width, height);
-  cairo_set_source_rgb (cr,
-    COLOR_R(src->background_color),
-    COLOR_G(src->background_color),
-    COLOR_B(src->background_color));
-  cairo_fill (cr);
+  gst_avsynctest_raster_erase (&src->coverage);
+}
 
-  // continue painting in foreground_color
-  cairo_set_source_rgb (cr,
-    COLOR_R(src->foreground_color),
-    COLOR_G(src->foreground_color),
-    COLOR_B(src->foreground_color));
+static void
+gst_avsynctestvideosrc_paint_line (GstAvSyncTestVideoSrc * src, double x0, double y0, double x1, double y1)
+{
+#ifdef HAVE_CAIRO
+  if (USE_CAIRO (src)) {
+    cairo_move_to (src->cairo, x0, y0);
+    cairo_line_to (src->cairo, x1, y1);
+    cairo_stroke (src->cairo);
+    return;
+  }
+#endif
 
-  // draw flash-rectangle outline
-  {
-    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(flash_rectangle, width, height);
+  gst_avsynctest_raster_line (&src->coverage, x0, y0, x1, y1, LINE_WIDTH);
+}
 
+static void
+gst_avsynctestvideosrc_paint_rectangle (GstAvSyncTestVideoSrc * src, double_rectangle_t r, gboolean fill)
+{
+#ifdef HAVE_CAIRO
+  if (USE_CAIRO (src)) {
+    cairo_t *cr = src->cairo;
     cairo_move_to (cr, r.left, r.top);
     cairo_line_to (cr, r.left + r.width, r.top);
     cairo_line_to (cr, r.left + r.width, r.top + r.height);
     cairo_line_to (cr, r.left, r.top + r.height);
     cairo_line_to (cr, r.left, r.top);
-    cairo_stroke (cr);
-  }
 
-  // draw amboss top and bottom line
-  {
-    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(amboss_rectangle, width, height);
+    if (fill) {
+      cairo_fill (cr);
+    } else {
+      cairo_stroke (cr);
+    }
+    return;
+  }
+#endif
 
-    cairo_move_to (cr, r.left, r.top);
-    cairo_line_to (cr, r.left + r.width, r.top);
-    cairo_stroke (cr);
+  if (fill) {
+    gst_avsynctest_raster_fill_rect (&src->coverage, r.left, r.top, r.width, r.height);
+  } else {
+    gst_avsynctest_raster_rect_outline (&src->coverage, r.left, r.top, r.width, r.height, LINE_WIDTH);
+  }
+}
 
-    cairo_move_to (cr, r.left, r.top + r.height);
-    cairo_line_to (cr, r.left + r.width, r.top + r.height);
-    cairo_stroke (cr);
+#ifdef HAVE_CAIRO
+/* shapes the digits once per font-size, instead of every label on its own */
+static void
+gst_avsynctestvideosrc_ensure_digit_glyphs (GstAvSyncTestVideoSrc * src, double size)
+{
+  cairo_set_font_size (src->cairo, size);
+  if (src->digit_size == size) {
+    return;
   }
 
-  // draw timeline
-  {
-    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(timeline_rectangle, width, height);
+  cairo_scaled_font_t *font = cairo_get_scaled_font (src->cairo);
+  cairo_font_extents_t font_extents;
+  cairo_scaled_font_extents (font, &font_extents);
+  src->digit_ascent = font_extents.ascent;
 
-    // horizontal line
-    {
-      cairo_move_to (cr, r.left, (r.top + r.height / 2));
-      cairo_line_to (cr, r.left + r.width, (r.top + r.height / 2));
-      cairo_stroke (cr);
+  for (gint digit = 0; digit < 10; digit++) {
+    gchar text[2] = { '0' + digit, '\0' };
+    cairo_glyph_t *glyphs = NULL;
+    gint n_glyphs = 0;
+
+    src->digit_glyphs[digit] = 0;
+    src->digit_advances[digit] = 0;
+
+    if (cairo_scaled_font_text_to_glyphs (font, 0, 0, text, 1, &glyphs, &n_glyphs, NULL, NULL, NULL) == CAIRO_STATUS_SUCCESS &&
+        n_glyphs == 1) {
+      cairo_text_extents_t extents;
+      cairo_scaled_font_glyph_extents (font, glyphs, 1, &extents);
+
+      src->digit_glyphs[digit] = glyphs[0].index;
+      src->digit_advances[digit] = extents.x_advance;
+    }
+
+    cairo_glyph_free (glyphs);
+  }
+
+  src->digit_size = size;
+}
+#endif
+
+/* text may only consist of digits, for both rasterizers */
+static void
+gst_avsynctestvideosrc_text_extents (GstAvSyncTestVideoSrc * src, const gchar * text, double size, double *width, double *ascent)
+{
+#ifdef HAVE_CAIRO
+  if (USE_CAIRO (src)) {
+    gst_avsynctestvideosrc_ensure_digit_glyphs (src, size);
+
+    *width = 0;
+    for (const gchar *c = text; *c != '\0'; c++) {
+      g_return_if_fail (g_ascii_isdigit (*c));
+      *width += src->digit_advances[*c - '0'];
     }
 
-    // time steps
+    *ascent = src->digit_ascent;
+    return;
+  }
+#endif
+
+  gst_avsynctest_raster_text_extents (text, size, width, ascent);
+}
+
+static void
+gst_avsynctestvideosrc_paint_text (GstAvSyncTestVideoSrc * src, const gchar * text, double size, double x, double baseline)
+{
+#ifdef HAVE_CAIRO
+  if (USE_CAIRO (src)) {
+    gst_avsynctestvideosrc_ensure_digit_glyphs (src, size);
+
+    cairo_glyph_t glyphs[16];
+    gint n_glyphs = 0;
+    for (const gchar *c = text; *c != '\0' && n_glyphs < G_N_ELEMENTS (glyphs); c++, n_glyphs++) {
+      g_return_if_fail (g_ascii_isdigit (*c));
+
+      glyphs[n_glyphs].index = src->digit_glyphs[*c - '0'];
+      glyphs[n_glyphs].x = x;
+      glyphs[n_glyphs].y = baseline;
+      x += src->digit_advances[*c - '0'];
+    }
+
+    cairo_show_glyphs (src->cairo, glyphs, n_glyphs);
+    return;
+  }
+#endif
+
+  gst_avsynctest_raster_show_text (&src->coverage, text, size, x, baseline);
+}
+
+/*
+ * smallest of 1, 2, 5, 10, 20, 50, … frames whose ticks are at least
+ * min_spacing pixels apart, so the number of ticks is bounded by the
+ * width of the timeline and not by the framerate
+ */
+static gint
+gst_avsynctestvideosrc_tick_step (double distance, double min_spacing)
+{
+  for (gint decade = 1; decade < G_MAXINT / 10; decade *= 10) {
+    static const gint multiples[] = { 1, 2, 5 };
+
+    for (guint i = 0; i < G_N_ELEMENTS (multiples); i++) {
+      if (multiples[i] * decade * distance >= min_spacing) {
+        return multiples[i] * decade;
+      }
+    }
+  }
+
+  return 1000000000;
+}
+
+static void
+gst_avsynctestvideosrc_paint_background (GstAvSyncTestVideoSrc * src)
+{
+  double width = src->coverage.width;
+  double height = src->coverage.height;
+
+  // clear to zero coverage, which is rendered in background_color
+  gst_avsynctestvideosrc_paint_erase (src);
+
+  // draw flash-rectangle outline
+  {
+    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(flash_rectangle, width, height);
+    gst_avsynctestvideosrc_paint_rectangle (src, r, FALSE);
+  }
+
+  // draw amboss top and bottom line
+  {
+    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(amboss_rectangle, width, height);
+
+    gst_avsynctestvideosrc_paint_line (src, r.left, r.top, r.left + r.width, r.top);
+    gst_avsynctestvideosrc_paint_line (src, r.left, r.top + r.height, r.left + r.width, r.top + r.height);
+  }
+
+  // draw timeline
+  {
+    double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(timeline_rectangle, width, height);
+
+    // horizontal line
+    gst_avsynctestvideosrc_paint_line (src, r.left, (r.top + r.height / 2), r.left + r.width, (r.top + r.height / 2));
+
+    // time steps, one second of frames centered on the timeline
     {
-      gint n_frames = src->video_info.fps_n;
+      gint n_frames = MAX (gst_util_uint64_scale_int_ceil (1, src->video_info.fps_n, MAX (src->video_info.fps_d, 1)), 2);
       gint center_frame = n_frames / 2;
-      GST_DEBUG_OBJECT(src, "n_frames=%d, n_frames=%d", n_frames, n_frames);
+      double distance = r.width / (n_frames - 1);
 
-      double distance = (double)1 / (n_frames - 1) * r.width;
-      char n_text[5];
-
-      // lines
-      for(gint n = 0; n < n_frames; n++)
+      // at high framerates only every n'th tick is drawn, so the ticks stay apart
+      gint tick_step = gst_avsynctestvideosrc_tick_step (distance, MIN_TICK_SPACING);
+      for (gint64 n = center_frame % tick_step; n < n_frames; n += tick_step)
       {
         double x = distance * n;
-
-        cairo_move_to (cr, r.left + x, r.top);
-        cairo_line_to (cr, r.left + x, r.top + r.height);
-        cairo_stroke (cr);
+        gst_avsynctestvideosrc_paint_line (src, r.left + x, r.top, r.left + x, r.top + r.height);
       }
 
       // labels
-      cairo_set_font_size(cr, height/30);
-      cairo_text_extents_t extents;
-
-      cairo_font_extents_t font_extents;
-      cairo_font_extents (cr, &font_extents);
+      double font_size = height / 30;
+      double text_width, ascent;
+      gchar n_text[16];
+
+      // the outermost label is the widest, it selects the n'th tick to label
+      g_snprintf (n_text, sizeof (n_text), "%d", center_frame);
+      gst_avsynctestvideosrc_text_extents (src, n_text, font_size, &text_width, &ascent);
+
+      gint label_step = gst_avsynctestvideosrc_tick_step (distance, MAX (text_width * LABEL_SPACING, MIN_TICK_SPACING));
+      if (label_step % tick_step != 0) {
+        // 5 after 2 in the same decade, 10 is the next one labelling drawn ticks only
+        label_step *= 2;
+      }
 
-      // estimate max widh of label, select n'th label to draw
-      g_snprintf(n_text, 5, "%d", n_frames);
-      cairo_text_extents (cr, n_text, &extents);
-      gint nth_label = ceil(extents.width / distance);
-      GST_DEBUG_OBJECT(src,
-        "estimated max. label-width to %f, drawing lines every %f pixels, thus displaying every %d'th label",
-        extents.width, distance, nth_label);
+      GST_DEBUG_OBJECT (src,
+        "%d frames %f pixels apart, drawing every %d'th tick and labelling every %d'th for a label-width of %f",
+        n_frames, distance, tick_step, label_step, text_width);
 
-      for(gint n = 0; n < n_frames; n++)
+      for (gint64 n = center_frame % label_step; n < n_frames; n += label_step)
       {
         double x = distance * n;
 
-        gint n_frame = abs(n - center_frame);
-        g_snprintf(n_text, 5, "%d", n_frame);
-        cairo_text_extents (cr, n_text, &extents);
-
-        if(n % nth_label == 0)
-        {
-          cairo_move_to (cr, r.left + x - extents.width/2, r.top + r.height + font_extents.ascent);
-          cairo_show_text(cr, n_text);
-        }
+        g_snprintf (n_text, sizeof (n_text), "%" G_GINT64_FORMAT, ABS (n - center_frame));
+        gst_avsynctestvideosrc_text_extents (src, n_text, font_size, &text_width, &ascent);
+        gst_avsynctestvideosrc_paint_text (src, n_text, font_size,
+          r.left + x - text_width/2, r.top + r.height + ascent);
       }
     }
   }
 }
 
 static void
-gst_avsynctestvideosrc_draw_frame(GstAvSyncTestVideoSrc *src)
+gst_avsynctestvideosrc_draw_flash(GstAvSyncTestVideoSrc *src)
 {
-  cairo_t *cr = src->cairo;
-  double width = cairo_image_surface_get_width (src->surface);
-  double height = cairo_image_surface_get_height (src->surface);
-
-  gint n_frames = src->video_info.fps_n;
+  double width = src->coverage.width;
+  double height = src->coverage.height;
 
   // draw flash area
-  if((src->n_frames % n_frames) == 0)
   {
     double_rectangle_t r = gst_avsynctestvideosrc_scale_rectangle(flash_rectangle, width, height);
+    gst_avsynctestvideosrc_paint_rectangle (src, r, TRUE);
+  }
+}
 
-    cairo_move_to (cr, r.left, r.top);
-    cairo_line_to (cr, r.left + r.width, r.top);
-    cairo_line_to (cr, r.left + r.width, r.top + r.height);
-    cairo_line_to (cr, r.left, r.top + r.height);
-    cairo_line_to (cr, r.left, r.top);
-    cairo_fill (cr);
+/* arguments of the slices of one render- or copy-job */
+typedef struct
+{
+  GstVideoFrame *dest;
+  const GstVideoFrame *src;
+  const GstAvSyncTestDirtyRegion *region;
+
+  const guint8 *coverage;
+  gint coverage_stride;
+  const GstAvSyncTestPalette *palette;
+} GstAvSyncTestVideoSrcSliceJob;
+
+static void
+gst_avsynctestvideosrc_render_slice (gpointer user_data, guint slice, guint n_slices)
+{
+  GstAvSyncTestVideoSrcSliceJob *job = user_data;
+  gst_avsynctest_render_coverage_slice (job->dest, job->coverage, job->coverage_stride, job->palette, slice, n_slices);
+}
+
+static void
+gst_avsynctestvideosrc_copy_slice (gpointer user_data, guint slice, guint n_slices)
+{
+  GstAvSyncTestVideoSrcSliceJob *job = user_data;
+  gst_avsynctest_frame_copy_slice (job->dest, job->src, slice, n_slices);
+}
+
+static void
+gst_avsynctestvideosrc_copy_region_slice (gpointer user_data, guint slice, guint n_slices)
+{
+  GstAvSyncTestVideoSrcSliceJob *job = user_data;
+  gst_avsynctest_dirty_region_copy_slice (job->dest, job->src, job->region, slice, n_slices);
+}
+
+/* copies the coverage-map, the variants are rendered and recolored from these copies */
+static GstBuffer *
+gst_avsynctestvideosrc_snapshot_coverage(GstAvSyncTestVideoSrc *src)
+{
+#ifdef HAVE_CAIRO
+  if (src->surface != NULL) {
+    cairo_surface_flush(src->surface);
   }
+#endif
+
+  gsize size = (gsize) src->coverage.stride * src->coverage.height;
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_fill (buffer, 0, src->coverage.data, size);
+
+  return buffer;
 }
 
+static GstBuffer *
+gst_avsynctestvideosrc_render_variant(GstAvSyncTestVideoSrc *src, GstBuffer *coverage, const GstAvSyncTestPalette *palette)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, src->video_info.size, NULL);
+
+  // clear the padding, so that it never shows up as dirty region
+  gst_buffer_memset (buffer, 0, 0, src->video_info.size);
+
+  GstMapInfo coverage_map;
+  gst_buffer_map (coverage, &coverage_map, GST_MAP_READ);
+
+  GstVideoFrame frame;
+  gst_video_frame_map (&frame, &src->video_info, buffer, GST_MAP_WRITE);
+
+  GstAvSyncTestVideoSrcSliceJob job = {
+    .dest = &frame,
+    .coverage = coverage_map.data,
+    .coverage_stride = GST_ROUND_UP_4 (src->video_info.width),
+    .palette = palette,
+  };
+  gst_avsynctest_slice_runner_run (src->slice_runner,
+    gst_avsynctestvideosrc_n_slices (src, src->video_info.height),
+    gst_avsynctestvideosrc_render_slice, &job);
+
+  gst_video_frame_unmap (&frame);
+  gst_buffer_unmap (coverage, &coverage_map);
+
+  // the memory is shared with downstream in zero-copy mode, nobody may write to it
+  GST_MINI_OBJECT_FLAG_SET (gst_buffer_peek_memory (buffer, 0), GST_MEMORY_FLAG_READONLY);
+
+  return buffer;
+}
+
+/* finds the region each variant differs from the background in */
+static void
+gst_avsynctestvideosrc_diff_variants(GstAvSyncTestVideoSrc *src)
+{
+  g_free (src->variant_regions);
+  src->variant_regions = g_new0 (GstAvSyncTestDirtyRegion, src->frame_variants->len);
+
+  GstVideoFrame background_frame;
+  gst_video_frame_map (&background_frame, &src->video_info, g_ptr_array_index (src->frame_variants, FRAME_VARIANT_BACKGROUND), GST_MAP_READ);
+  for (guint variant_idx = 0; variant_idx < src->frame_variants->len; variant_idx++) {
+    GstVideoFrame variant_frame;
+    gst_video_frame_map (&variant_frame, &src->video_info, g_ptr_array_index (src->frame_variants, variant_idx), GST_MAP_READ);
+    gst_avsynctest_dirty_region_diff (&background_frame, &variant_frame, &src->variant_regions[variant_idx]);
+    gst_video_frame_unmap (&variant_frame);
+  }
+  gst_video_frame_unmap (&background_frame);
+}
+
+static void
+gst_avsynctestvideosrc_render_variants(GstAvSyncTestVideoSrc *src, guint foreground_color, guint background_color)
+{
+  gst_avsynctestvideosrc_free_variants(src);
+  src->frame_variants = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+  src->variant_coverage = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  // the variants build on each other, so they are painted in order onto the same coverage-map
+  gst_avsynctestvideosrc_paint_background(src);
+  g_ptr_array_add (src->variant_coverage, gst_avsynctestvideosrc_snapshot_coverage(src));
+
+  gst_avsynctestvideosrc_draw_flash(src);
+  g_ptr_array_add (src->variant_coverage, gst_avsynctestvideosrc_snapshot_coverage(src));
+
+  g_assert (src->variant_coverage->len == N_FRAME_VARIANTS);
+
+  GstAvSyncTestPalette palette;
+  gst_avsynctest_palette_init (&palette, &src->video_info, foreground_color, background_color);
+
+  for (guint variant_idx = 0; variant_idx < src->variant_coverage->len; variant_idx++) {
+    g_ptr_array_add (src->frame_variants,
+      gst_avsynctestvideosrc_render_variant(src, g_ptr_array_index (src->variant_coverage, variant_idx), &palette));
+  }
+
+  gst_avsynctestvideosrc_diff_variants(src);
+
+  src->variant_foreground_color = foreground_color;
+  src->variant_background_color = background_color;
+  src->variant_generation++;
+
+  GST_DEBUG_OBJECT (src, "rendered %d frame variants of %" G_GSIZE_FORMAT " bytes",
+    src->frame_variants->len, gst_buffer_get_size (g_ptr_array_index (src->frame_variants, 0)));
+}
+
+/*
+ * Re-renders the frame variants from their coverage-maps in the given
+ * colors. The previous variants may still be in flight, so they are
+ * replaced and never written to.
+ */
+static void
+gst_avsynctestvideosrc_recolor_variants(GstAvSyncTestVideoSrc *src, guint foreground_color, guint background_color)
+{
+  if (gst_avsynctestvideosrc_acquire_variants(src, foreground_color, background_color)) {
+    // another instance already recolored them
+    return;
+  }
+
+  GST_DEBUG_OBJECT (src, "recoloring frame variants to foreground 0x%08X, background 0x%08X",
+    foreground_color, background_color);
+
+  GstAvSyncTestPalette palette;
+  gst_avsynctest_palette_init (&palette, &src->video_info, foreground_color, background_color);
+
+  g_ptr_array_unref (src->frame_variants);
+  src->frame_variants = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  for (guint variant_idx = 0; variant_idx < src->variant_coverage->len; variant_idx++) {
+    g_ptr_array_add (src->frame_variants,
+      gst_avsynctestvideosrc_render_variant(src, g_ptr_array_index (src->variant_coverage, variant_idx), &palette));
+  }
+
+  gst_avsynctestvideosrc_diff_variants(src);
+
+  src->variant_foreground_color = foreground_color;
+  src->variant_background_color = background_color;
+
+  // recycled buffers hold the variants in the previous colors
+  src->variant_generation++;
+
+  gst_avsynctestvideosrc_publish_variants(src);
+}
+
+/*
+ * applies controlled properties at the frame boundary before the frame at
+ * pts. An encoded loop is re-encoded off the streaming-thread and keeps
+ * being replayed in the previous colors until that is done.
+ */
 static GstFlowReturn
-gst_avsynctestvideosrc_fill (GstPushSrc * base, GstBuffer *buffer)
+gst_avsynctestvideosrc_sync_colors(GstAvSyncTestVideoSrc *src, GstClockTime pts)
 {
-  GstAvSyncTestVideoSrc *src = GST_AV_SYNC_TEST_VIDEO_SRC (base);
+  GstClockTime stream_time = gst_segment_to_stream_time (&GST_BASE_SRC (src)->segment, GST_FORMAT_TIME, pts);
+  if (GST_CLOCK_TIME_IS_VALID (stream_time)) {
+    gst_object_sync_values (GST_OBJECT (src), stream_time);
+  }
 
-  /* 0 framerate and we are at the second frame, eos */
-  if (G_UNLIKELY (src->video_info.fps_n == 0 && src->n_frames == 1)) {
-    goto eos;
+  // one consistent pair for the key, the palette and the rendered colors
+  guint foreground_color, background_color;
+  gst_avsynctestvideosrc_snapshot_colors(src, &foreground_color, &background_color);
+
+  if (foreground_color != src->variant_foreground_color ||
+      background_color != src->variant_background_color) {
+    gst_avsynctestvideosrc_recolor_variants(src, foreground_color, background_color);
+
+    // a running encode picks the new colors up once it is swapped in
+    if (src->encoded_frames != NULL && src->encode_thread == NULL &&
+        !gst_avsynctestvideosrc_start_encode(src)) {
+      return GST_FLOW_ERROR;
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_avsynctestvideosrc_snapshot_colors (GstAvSyncTestVideoSrc *src, guint *foreground_color, guint *background_color)
+{
+  GST_OBJECT_LOCK (src);
+  *foreground_color = src->foreground_color;
+  *background_color = src->background_color;
+  GST_OBJECT_UNLOCK (src);
+}
+
+static void
+gst_avsynctestvideosrc_variant_key (GstAvSyncTestVideoSrc *src, guint foreground_color, guint background_color,
+  GstAvSyncTestVariantKey *key)
+{
+  key->video_info = src->video_info;
+  key->foreground_color = foreground_color;
+  key->background_color = background_color;
+  key->rasterizer = src->rasterizer;
+}
+
+/* takes the frame variants from the cache, returns FALSE when they need to be rendered */
+static gboolean
+gst_avsynctestvideosrc_lookup_variants(GstAvSyncTestVideoSrc *src, guint foreground_color, guint background_color)
+{
+  GstAvSyncTestVariantKey key;
+  gst_avsynctestvideosrc_variant_key (src, foreground_color, background_color, &key);
+
+  gst_avsynctest_variant_cache_set_budget (&src->variant_cache, MIN (src->variant_cache_size, G_MAXSIZE));
+  const GstAvSyncTestVariantEntry *entry = gst_avsynctest_variant_cache_lookup (&src->variant_cache, &key);
+
+  GST_DEBUG_OBJECT (src, "variant cache %s, %u hits, %u misses, %" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT " bytes used",
+    entry != NULL ? "hit" : "miss", src->variant_cache.hits, src->variant_cache.misses,
+    src->variant_cache.size, src->variant_cache.budget);
+
+  if (entry == NULL) {
+    return FALSE;
+  }
+
+  gst_avsynctestvideosrc_take_variants(src, entry);
+  return TRUE;
+}
+
+static void
+gst_avsynctestvideosrc_take_variants(GstAvSyncTestVideoSrc *src, const GstAvSyncTestVariantEntry *entry)
+{
+  gst_avsynctestvideosrc_free_variants(src);
+  src->frame_variants = g_ptr_array_ref (entry->frame_variants);
+  src->variant_coverage = g_ptr_array_ref (entry->variant_coverage);
+  src->variant_foreground_color = entry->key.foreground_color;
+  src->variant_background_color = entry->key.background_color;
+
+  src->variant_regions = g_new (GstAvSyncTestDirtyRegion, entry->frame_variants->len);
+  memcpy (src->variant_regions, entry->variant_regions, sizeof (GstAvSyncTestDirtyRegion) * entry->frame_variants->len);
+
+  // recycled buffers hold the variants of the previous caps or colors
+  src->variant_generation++;
+}
+
+/*
+ * Takes the variants for the current caps and the given colors from the variant
+ * store, when another instance already published them. Returns FALSE when
+ * this instance is the first one and has to publish them.
+ */
+static gboolean
+gst_avsynctestvideosrc_acquire_variants(GstAvSyncTestVideoSrc *src, guint foreground_color, guint background_color)
+{
+  GstAvSyncTestVariantKey key;
+  gst_avsynctestvideosrc_variant_key (src, foreground_color, background_color, &key);
+
+  gboolean ready;
+  GstAvSyncTestVariantEntry *entry = gst_avsynctest_variant_store_acquire (&key, &ready);
+
+  if (src->shared_variants != NULL) {
+    gst_avsynctest_variant_store_release (src->shared_variants);
+  }
+  src->shared_variants = entry;
+
+  if (!ready) {
+    return FALSE;
   }
 
-  GST_BUFFER_PTS (buffer) = gst_util_uint64_scale (
+  GST_DEBUG_OBJECT (src, "sharing the frame variants of another instance");
+  gst_avsynctestvideosrc_take_variants(src, entry);
+  return TRUE;
+}
+
+static void
+gst_avsynctestvideosrc_publish_variants(GstAvSyncTestVideoSrc *src)
+{
+  gst_avsynctest_variant_store_publish (src->shared_variants,
+    src->frame_variants, src->variant_coverage, src->variant_regions);
+}
+
+static void
+gst_avsynctestvideosrc_cache_variants(GstAvSyncTestVideoSrc *src)
+{
+  // keyed by the colors the variants were actually rendered in
+  GstAvSyncTestVariantKey key;
+  gst_avsynctestvideosrc_variant_key (src, src->variant_foreground_color, src->variant_background_color, &key);
+
+  gst_avsynctest_variant_cache_insert (&src->variant_cache, &key,
+    src->frame_variants, src->variant_coverage, src->variant_regions);
+}
+
+/*
+ * Tabulates the variant of every frame of one period of the timeline. A
+ * period longer than GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH leaves
+ * frame_schedule NULL, its frames are then looked up one by one.
+ */
+static void
+gst_avsynctestvideosrc_build_schedule(GstAvSyncTestVideoSrc *src)
+{
+  gst_avsynctest_timeline_init (&src->timeline, src->video_info.fps_n, src->video_info.fps_d,
+    src->sync_interval, src->sync_interval_frames, src->sync_pattern);
+
+  g_free (src->frame_schedule);
+  src->frame_schedule = NULL;
+
+  src->schedule_length = gst_avsynctest_timeline_schedule_length (&src->timeline);
+  if (src->schedule_length == 0) {
+    GST_DEBUG_OBJECT (src, "the sync-points repeat after more than %d frames, looking up every frame",
+      GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH);
+    return;
+  }
+
+  src->frame_schedule = g_malloc0 (src->schedule_length);
+
+  // a still image only ever shows its first frame
+  if (src->video_info.fps_n <= 0) {
+    src->frame_schedule[0] = FRAME_VARIANT_FLASH;
+    return;
+  }
+
+  for (guint64 k = 0; ; k++) {
+    guint64 frame = gst_avsynctest_timeline_sync_frame (&src->timeline, k);
+    if (frame >= (guint64) src->schedule_length) {
+      break;
+    }
+
+    src->frame_schedule[frame] = FRAME_VARIANT_FLASH;
+    if (gst_avsynctest_timeline_has_second_marker (&src->timeline, k)) {
+      src->frame_schedule[gst_avsynctest_timeline_second_frame (&src->timeline, k)] = FRAME_VARIANT_FLASH;
+    }
+  }
+
+  GST_DEBUG_OBJECT (src, "the sync-points repeat every %d frames", src->schedule_length);
+}
+
+/*
+ * The frames to encode: one period of the schedule, or every variant once
+ * for intra-only formats. NULL when the schedule can not be looped.
+ */
+static GPtrArray *
+gst_avsynctestvideosrc_encode_frames(GstAvSyncTestVideoSrc *src, gboolean *intra_only)
+{
+  const gchar *media_type = gst_structure_get_name (gst_caps_get_structure (src->encoded_caps, 0));
+  *intra_only = gst_avsynctest_encoder_is_intra_only (media_type);
+
+  if (!*intra_only && src->frame_schedule == NULL) {
+    GST_ELEMENT_ERROR (src, STREAM, ENCODE, (NULL),
+      ("the sync-points do not repeat within %d frames, can not loop them in %s",
+        GST_AV_SYNC_TEST_MAX_SCHEDULE_LENGTH, media_type));
+    return NULL;
+  }
+
+  GPtrArray *frames = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+  if (*intra_only) {
+    for (guint variant_idx = 0; variant_idx < src->frame_variants->len; variant_idx++) {
+      g_ptr_array_add (frames, gst_buffer_ref (g_ptr_array_index (src->frame_variants, variant_idx)));
+    }
+  } else {
+    for (gint n = 0; n < src->schedule_length; n++) {
+      g_ptr_array_add (frames, gst_buffer_ref (g_ptr_array_index (src->frame_variants, src->frame_schedule[n])));
+    }
+  }
+
+  return frames;
+}
+
+/*
+ * Encodes one period of the schedule into encoded_frames, indexed like the
+ * schedule. Intra-only formats only encode every variant once and index
+ * encoded_frames by variant instead.
+ */
+static gboolean
+gst_avsynctestvideosrc_encode_variants(GstAvSyncTestVideoSrc *src)
+{
+  const gchar *media_type = gst_structure_get_name (gst_caps_get_structure (src->encoded_caps, 0));
+  gboolean intra_only;
+
+  GPtrArray *frames = gst_avsynctestvideosrc_encode_frames (src, &intra_only);
+  if (frames == NULL) {
+    return FALSE;
+  }
+
+  GPtrArray *encoded = gst_avsynctest_encode_loop (GST_OBJECT (src), &src->video_info, src->encoded_caps, frames);
+  g_ptr_array_unref (frames);
+
+  if (encoded == NULL) {
+    GST_ELEMENT_ERROR (src, STREAM, ENCODE, (NULL), ("could not encode the test-card into %s", media_type));
+    return FALSE;
+  }
+
+  if (src->encoded_frames != NULL) {
+    g_ptr_array_unref (src->encoded_frames);
+  }
+
+  src->encoded_frames = encoded;
+  src->encoded_intra_only = intra_only;
+
+  GST_DEBUG_OBJECT (src, "encoded %s of %u frames into %s",
+    intra_only ? "the variants" : "a loop", src->encoded_frames->len, media_type);
+  return TRUE;
+}
+
+/* one re-encoding of the variants, owned by the streaming-thread again after the join */
+struct _GstAvSyncTestVideoSrcEncodeJob
+{
+  GstObject *parent;
+  GstVideoInfo video_info;
+  GstCaps *caps;
+  GPtrArray *frames;
+  // variant_generation the frames were taken from
+  guint generation;
+
+  GPtrArray *encoded;
+  gint done;
+};
+
+static gpointer
+gst_avsynctestvideosrc_encode_thread (gpointer user_data)
+{
+  GstAvSyncTestVideoSrcEncodeJob *job = user_data;
+
+  job->encoded = gst_avsynctest_encode_loop (job->parent, &job->video_info, job->caps, job->frames);
+  g_atomic_int_set (&job->done, TRUE);
+
+  return NULL;
+}
+
+/* re-encodes the current variants on encode_thread, the streaming-thread keeps replaying the old loop */
+static gboolean
+gst_avsynctestvideosrc_start_encode(GstAvSyncTestVideoSrc *src)
+{
+  gboolean intra_only;
+  GPtrArray *frames = gst_avsynctestvideosrc_encode_frames (src, &intra_only);
+  if (frames == NULL) {
+    return FALSE;
+  }
+
+  GstAvSyncTestVideoSrcEncodeJob *job = g_new0 (GstAvSyncTestVideoSrcEncodeJob, 1);
+  job->parent = GST_OBJECT (src);
+  job->video_info = src->video_info;
+  job->caps = gst_caps_ref (src->encoded_caps);
+  job->frames = frames;
+  job->generation = src->variant_generation;
+
+  GST_DEBUG_OBJECT (src, "re-encoding %u frames in the new colors", frames->len);
+  src->encode_job = job;
+  src->encode_thread = g_thread_new ("avsynctestencode", gst_avsynctestvideosrc_encode_thread, job);
+  return TRUE;
+}
+
+/* waits for encode_thread and returns what it encoded, NULL when encoding failed */
+static GPtrArray *
+gst_avsynctestvideosrc_join_encode(GstAvSyncTestVideoSrc *src, guint *generation)
+{
+  g_thread_join (src->encode_thread);
+  src->encode_thread = NULL;
+
+  GstAvSyncTestVideoSrcEncodeJob *job = src->encode_job;
+  src->encode_job = NULL;
+
+  GPtrArray *encoded = job->encoded;
+  *generation = job->generation;
+
+  gst_caps_unref (job->caps);
+  g_ptr_array_unref (job->frames);
+  g_free (job);
+
+  return encoded;
+}
+
+/*
+ * Swaps in the loop re-encoded by encode_thread once it is done. A predicted
+ * loop is only swapped at its start, where the decoder finds its keyframe.
+ */
+static GstFlowReturn
+gst_avsynctestvideosrc_swap_encoded(GstAvSyncTestVideoSrc *src)
+{
+  if (src->encode_thread == NULL || !g_atomic_int_get (&src->encode_job->done)) {
+    return GST_FLOW_OK;
+  }
+
+  if (src->encode_job->encoded != NULL && !src->encoded_intra_only &&
+      src->n_frames % src->encoded_frames->len != 0) {
+    return GST_FLOW_OK;
+  }
+
+  guint generation;
+  GPtrArray *encoded = gst_avsynctestvideosrc_join_encode (src, &generation);
+  if (encoded == NULL) {
+    GST_ELEMENT_ERROR (src, STREAM, ENCODE, (NULL), ("could not re-encode the test-card in the new colors"));
+    return GST_FLOW_ERROR;
+  }
+
+  g_ptr_array_unref (src->encoded_frames);
+  src->encoded_frames = encoded;
+  GST_DEBUG_OBJECT (src, "swapped in the re-encoded frames at frame %" G_GINT64_FORMAT, src->n_frames);
+
+  // the colors changed again while encoding
+  if (generation != src->variant_generation && !gst_avsynctestvideosrc_start_encode (src)) {
+    return GST_FLOW_ERROR;
+  }
+
+  return GST_FLOW_OK;
+}
+
+static GstClockTime
+gst_avsynctestvideosrc_frame_pts (GstAvSyncTestVideoSrc *src)
+{
+  return gst_util_uint64_scale (
     src->n_frames,
     src->video_info.fps_d * GST_SECOND,
     src->video_info.fps_n);
+}
+
+static void
+gst_avsynctestvideosrc_timestamp_buffer (GstAvSyncTestVideoSrc *src, GstBuffer *buffer)
+{
+  GST_BUFFER_PTS (buffer) = gst_avsynctestvideosrc_frame_pts (src);
 
   GST_BUFFER_DTS (buffer) = GST_CLOCK_TIME_NONE;
   GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale (
     GST_SECOND,
     src->video_info.fps_d,
     src->video_info.fps_n);
+}
+
+static guint8
+gst_avsynctestvideosrc_current_variant_idx (GstAvSyncTestVideoSrc *src)
+{
+  if (src->frame_schedule != NULL) {
+    return src->frame_schedule[src->n_frames % src->schedule_length];
+  }
+
+  return gst_avsynctest_timeline_is_marker_frame (&src->timeline, src->n_frames) ?
+    FRAME_VARIANT_FLASH : FRAME_VARIANT_BACKGROUND;
+}
 
-  //cairo_push_group (src->cairo);
-  gst_avsynctestvideosrc_draw_frame(src);
+/*
+ * queues and signals the sync-point, when the timestamped buffer of the
+ * current frame shows the flash of a sync-point rather than its second marker
+ */
+static gboolean
+gst_avsynctestvideosrc_sync_point (GstAvSyncTestVideoSrc *src, GstBuffer *buffer)
+{
+  if (gst_avsynctestvideosrc_current_variant_idx(src) != FRAME_VARIANT_FLASH) {
+    return FALSE;
+  }
 
-  src->n_frames++;
+  if (!gst_avsynctest_timeline_is_sync_frame (&src->timeline, src->n_frames)) {
+    return FALSE;
+  }
 
-  GstVideoFrame frame;
-  gst_video_frame_map (&frame, &src->video_info, buffer, GST_MAP_WRITE);
+  GstAvSyncTestSyncEvent event = {
+    .pts = GST_BUFFER_PTS (buffer),
+    .running_time = gst_segment_to_running_time (&GST_BASE_SRC (src)->segment, GST_FORMAT_TIME, GST_BUFFER_PTS (buffer)),
+    .index = src->n_frames,
+  };
 
-  cairo_surface_t * surface = src->surface;
-  cairo_surface_flush(surface);
-  unsigned char * cairo_pixels = cairo_image_surface_get_data(surface);
-  int cairo_width = cairo_image_surface_get_width (surface);
-  int cairo_height = cairo_image_surface_get_height (surface);
-  int cairo_stride = cairo_image_surface_get_stride (surface);
+  if (!gst_avsynctest_sync_ring_push (&src->sync_ring, &event)) {
+    GST_LOG_OBJECT (src, "sync-point ring full, dropped sync-point of frame %" G_GUINT64_FORMAT, event.index);
+  }
+
+  if (src->emit_signals) {
+    g_signal_emit (src, gst_av_sync_test_video_src_signals[SIGNAL_SYNC_POINT], 0,
+      event.pts, event.running_time, event.index);
+  }
+
+  return TRUE;
+}
+
+/* tells downstream which frame the buffer holds and when it was generated */
+static void
+gst_avsynctestvideosrc_add_meta (GstAvSyncTestVideoSrc *src, GstBuffer *buffer, gboolean sync_point)
+{
+  gst_buffer_add_avsynctest_meta (buffer, src->n_frames, sync_point, src->n_frames);
+  gst_avsynctest_buffer_add_reference_timestamp (GST_ELEMENT (src), buffer);
+}
+
+static GstStructure *
+gst_avsynctestvideosrc_pull_sync_point (GstAvSyncTestVideoSrc * avsynctestvideosrc)
+{
+  return gst_avsynctest_sync_ring_pull (&avsynctestvideosrc->sync_ring);
+}
+
+static GstBuffer *
+gst_avsynctestvideosrc_current_variant (GstAvSyncTestVideoSrc *src)
+{
+  return g_ptr_array_index (src->frame_variants, gst_avsynctestvideosrc_current_variant_idx (src));
+}
+
+/*
+ * Find the region that needs to be rewritten to turn the contents of a
+ * recycled buffer into the variant variant_idx. Returns FALSE when the whole
+ * frame needs to be written.
+ */
+static gboolean
+gst_avsynctestvideosrc_buffer_dirty_region (GstAvSyncTestVideoSrc *src, GstBuffer *buffer, guint8 variant_idx, GstAvSyncTestDirtyRegion *region)
+{
+  if (!src->dirty_regions) {
+    return FALSE;
+  }
+
+  guint tag = GPOINTER_TO_UINT (gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST (buffer), variant_tag_quark));
+  if (tag == 0 || (tag >> 8) != (src->variant_generation & 0xFFFFFF)) {
+    // fresh buffer or filled with variants for other caps
+    return FALSE;
+  }
+
+  guint8 previous_idx = tag & 0xFF;
+  gst_avsynctest_dirty_region_union (&src->variant_regions[previous_idx], &src->variant_regions[variant_idx], region);
+
+  return TRUE;
+}
 
-  //cairo_pop_group (src->cairo);
+static gboolean
+gst_avsynctestvideosrc_is_eos (GstAvSyncTestVideoSrc *src)
+{
+  // a 0 framerate has a single frame, reverse playback ends after frame 0
+  return (src->video_info.fps_n == 0 && src->n_frames == 1) || src->n_frames < 0;
+}
 
-  unsigned char * gst_pixels = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
-  gint gst_width = GST_VIDEO_FRAME_WIDTH (&frame);
-  gint gst_height = GST_VIDEO_FRAME_HEIGHT (&frame);
-  gint gst_stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame, 0);
+static void
+gst_avsynctestvideosrc_advance (GstAvSyncTestVideoSrc *src)
+{
+  src->n_frames += src->reverse ? -1 : 1;
+}
 
-  if (G_UNLIKELY (cairo_width != gst_width)) {
-    GST_ERROR_OBJECT(src, "cairo width %d != gst width %d", cairo_width, gst_width);
-    goto incompatible_formats;
+/*
+ * Renders the band with the frame-counter over the variant copied into
+ * buffer. Its rows are replaced as a whole, so the variant-tag of a recycled
+ * buffer stays valid for the rest of the frame.
+ */
+static GstFlowReturn
+gst_avsynctestvideosrc_draw_timecode (GstAvSyncTestVideoSrc *src, GstBuffer *buffer, gint64 frame_index)
+{
+  if (!src->timecode) {
+    return GST_FLOW_OK;
   }
 
-  if (G_UNLIKELY (cairo_height != gst_height)) {
-    GST_ERROR_OBJECT(src, "cairo height %d != gst height %d", cairo_height, gst_height);
-    goto incompatible_formats;
+  // the band is drawn in the colors of the variants it is drawn over
+  if (src->timecode_generation != src->variant_generation) {
+    gst_avsynctest_palette_init (&src->timecode_palette, &src->video_info,
+      src->variant_foreground_color, src->variant_background_color);
+    src->timecode_generation = src->variant_generation;
   }
 
-  if (G_UNLIKELY (cairo_stride != gst_stride)) {
-    GST_ERROR_OBJECT(src, "cairo stride %d != gst stride %d", cairo_stride, gst_stride);
-    goto incompatible_formats;
+  gst_avsynctest_timecode_paint (&src->timecode_coverage, (guint32) frame_index);
+
+  GstVideoFrame frame;
+  if (G_UNLIKELY (!gst_video_frame_map (&frame, &src->video_info, buffer, GST_MAP_WRITE))) {
+    GST_ERROR_OBJECT(src, "could not map output buffer");
+    return GST_FLOW_ERROR;
   }
 
-  gint64 num_bytes = gst_height * gst_stride;
-  //GST_DEBUG_OBJECT (src, "memcpy %" G_GINT64_FORMAT " bytes from cairo to gst-buffer", num_bytes);
-  memcpy(gst_pixels, cairo_pixels, num_bytes);
+  gint y_start, y_end;
+  gst_avsynctest_timecode_rows (src->video_info.height, &y_start, &y_end);
+  gst_avsynctest_render_coverage_rows (&frame, src->timecode_coverage.data, src->timecode_coverage.stride,
+    &src->timecode_palette, y_start, y_end);
 
   gst_video_frame_unmap (&frame);
+  return GST_FLOW_OK;
+}
+
+/* replays the encoded loop, only the timestamps are rewritten */
+static GstFlowReturn
+gst_avsynctestvideosrc_create_encoded (GstAvSyncTestVideoSrc *src, GstBuffer ** buffer)
+{
+  if (G_UNLIKELY (gst_avsynctestvideosrc_is_eos (src))) {
+    GST_DEBUG_OBJECT (src, "eos: frame %d", (gint) src->n_frames);
+    return GST_FLOW_EOS;
+  }
+
+  GstFlowReturn ret = gst_avsynctestvideosrc_sync_colors(src, gst_avsynctestvideosrc_frame_pts (src));
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    return ret;
+  }
+
+  ret = gst_avsynctestvideosrc_swap_encoded(src);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    return ret;
+  }
+
+  // shares the memory and keeps the keyframe-flags of the encoded frame
+  guint idx = src->encoded_intra_only ?
+    gst_avsynctestvideosrc_current_variant_idx(src) : src->n_frames % src->encoded_frames->len;
+  *buffer = gst_buffer_copy (g_ptr_array_index (src->encoded_frames, idx));
+
+  gst_avsynctestvideosrc_timestamp_buffer(src, *buffer);
+  GST_BUFFER_DTS (*buffer) = GST_BUFFER_PTS (*buffer);
+  GST_BUFFER_OFFSET (*buffer) = src->n_frames;
+  GST_BUFFER_OFFSET_END (*buffer) = src->n_frames + 1;
+
+  gboolean sync_point = gst_avsynctestvideosrc_sync_point(src, *buffer);
+  gst_avsynctestvideosrc_add_meta (src, *buffer, sync_point);
+  gst_avsynctestvideosrc_advance (src);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_avsynctestvideosrc_create (GstBaseSrc * base, guint64 offset, guint length, GstBuffer ** buffer)
+{
+  GstAvSyncTestVideoSrc *src = GST_AV_SYNC_TEST_VIDEO_SRC (base);
+
+  if (src->encoded_frames != NULL) {
+    return gst_avsynctestvideosrc_create_encoded (src, buffer);
+  }
+
+  if (!src->zero_copy || src->timecode) {
+    // let GstPushSrc allocate a buffer and call fill, the shared variants can not carry a timecode
+    return GST_BASE_SRC_CLASS (parent_class)->create (base, offset, length, buffer);
+  }
+
+  if (G_UNLIKELY (gst_avsynctestvideosrc_is_eos (src))) {
+    GST_DEBUG_OBJECT (src, "eos: frame %d", (gint) src->n_frames);
+    return GST_FLOW_EOS;
+  }
+
+  GstFlowReturn ret = gst_avsynctestvideosrc_sync_colors(src, gst_avsynctestvideosrc_frame_pts (src));
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    return ret;
+  }
+
+  GstBuffer *variant = gst_avsynctestvideosrc_current_variant(src);
+  ret = gst_avsynctestframepool_acquire_frame (src->frame_pool, variant, buffer);
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    GST_DEBUG_OBJECT (src, "could not acquire frame from pool: %s", gst_flow_get_name (ret));
+    return ret;
+  }
+
+  gst_avsynctestvideosrc_timestamp_buffer(src, *buffer);
+  gboolean sync_point = gst_avsynctestvideosrc_sync_point(src, *buffer);
+  gst_avsynctestvideosrc_add_meta (src, *buffer, sync_point);
+  gst_avsynctestvideosrc_advance (src);
 
   return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_avsynctestvideosrc_fill (GstPushSrc * base, GstBuffer *buffer)
+{
+  GstAvSyncTestVideoSrc *src = GST_AV_SYNC_TEST_VIDEO_SRC (base);
+
+  if (G_UNLIKELY (gst_avsynctestvideosrc_is_eos (src))) {
+    goto eos;
+  }
+
+  gst_avsynctestvideosrc_timestamp_buffer(src, buffer);
+  GstFlowReturn ret = gst_avsynctestvideosrc_sync_colors(src, GST_BUFFER_PTS (buffer));
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    return ret;
+  }
+
+  // pick the pre-rendered variant for this frame
+  guint8 variant_idx = gst_avsynctestvideosrc_current_variant_idx(src);
+  GstBuffer *variant = g_ptr_array_index (src->frame_variants, variant_idx);
+
+  gboolean sync_point = gst_avsynctestvideosrc_sync_point(src, buffer);
+  gst_avsynctestvideosrc_add_meta (src, buffer, sync_point);
+  gint64 frame_index = src->n_frames;
+  gst_avsynctestvideosrc_advance (src);
+
+  GstAvSyncTestDirtyRegion region;
+  gboolean partial = gst_avsynctestvideosrc_buffer_dirty_region (src, buffer, variant_idx, &region);
+  if (partial && gst_avsynctest_dirty_region_is_empty (&region)) {
+    // recycled buffer already holds this variant
+    return gst_avsynctestvideosrc_draw_timecode (src, buffer, frame_index);
+  }
 
-incompatible_formats:
+  GstVideoFrame frame;
+  if (G_UNLIKELY (!gst_video_frame_map (&frame, &src->video_info, buffer, GST_MAP_WRITE))) {
+    GST_ERROR_OBJECT(src, "could not map output buffer");
+    return GST_FLOW_ERROR;
+  }
+
+  GstVideoFrame variant_frame;
+  gst_video_frame_map (&variant_frame, &src->video_info, variant, GST_MAP_READ);
+
+  // copies plane by plane and row by row, so the strides do not need to match
+  GstAvSyncTestVideoSrcSliceJob job = {
+    .dest = &frame,
+    .src = &variant_frame,
+    .region = &region,
+  };
+
+  if (partial) {
+    gint rows = 0;
+    for (guint plane = 0; plane < GST_VIDEO_MAX_PLANES; plane++) {
+      rows = MAX (rows, region.planes[plane].height);
+    }
+
+    gst_avsynctest_slice_runner_run (src->slice_runner,
+      gst_avsynctestvideosrc_n_slices (src, rows),
+      gst_avsynctestvideosrc_copy_region_slice, &job);
+  } else {
+    gst_avsynctest_slice_runner_run (src->slice_runner,
+      gst_avsynctestvideosrc_n_slices (src, src->video_info.height),
+      gst_avsynctestvideosrc_copy_slice, &job);
+  }
+
+  gst_video_frame_unmap (&variant_frame);
   gst_video_frame_unmap (&frame);
-  return GST_FLOW_ERROR;
+
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (buffer), variant_tag_quark,
+    GUINT_TO_POINTER (VARIANT_TAG (src->variant_generation & 0xFFFFFF, variant_idx)), NULL);
+
+  return gst_avsynctestvideosrc_draw_timecode (src, buffer, frame_index);
 
 eos:
   {
-    GST_DEBUG_OBJECT (src, "eos: 0 framerate, frame %d", (gint) src->n_frames);
+    GST_DEBUG_OBJECT (src, "eos: frame %d", (gint) src->n_frames);
     return GST_FLOW_EOS;
   }
 }
@@ -22,7 +22,15 @@
 #include <gst/base/gstpushsrc.h>
 #include <gst/video/video.h>
 
+#ifdef HAVE_CAIRO
 #include <cairo.h>
+#endif
+
+#include "avsynctestraster.h"
+#include "avsynctestrender.h"
+#include "avsynctestsyncring.h"
+#include "avsynctesttimeline.h"
+#include "avsynctestvariantcache.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_AV_SYNC_TEST_VIDEO_SRC           (gst_avsynctestvideosrc_get_type())
@@ -31,28 +39,120 @@ G_BEGIN_DECLS
 #define GST_IS_AV_SYNC_TEST_VIDEO_SRC(obj)        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_AV_SYNC_TEST_VIDEO_SRC))
 #define GST_IS_AV_SYNC_TEST_VIDEO_SRC_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE((klass),  GST_TYPE_AV_SYNC_TEST_VIDEO_SRC))
 typedef struct _GstAvSyncTestVideoSrc GstAvSyncTestVideoSrc;
+typedef struct _GstAvSyncTestVideoSrcEncodeJob GstAvSyncTestVideoSrcEncodeJob;
 typedef struct _GstAvSyncTestVideoSrcClass GstAvSyncTestVideoSrcClass;
 
+typedef enum
+{
+  GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_BUILTIN,
+  GST_AV_SYNC_TEST_VIDEO_SRC_RASTERIZER_CAIRO,
+} GstAvSyncTestVideoSrcRasterizer;
 
 struct _GstAvSyncTestVideoSrc
 {
   GstPushSrc base_avsynctestvideosrc;
   GstVideoInfo video_info;
 
+  /* controlled, protected by the object lock */
   guint foreground_color;
   guint background_color;
+  gboolean zero_copy;
+  gboolean dirty_regions;
 
   gint64 n_frames;
+  // played backwards, n_frames counts down to frame 0
+  gboolean reverse;
+  // time seeked to before the framerate was known, applied to n_frames by set_caps
+  GstClockTime seek_position;
+
+  GstAvSyncTestVideoSrcRasterizer rasterizer;
 
+  /* only alive while the frame variants are rendered in set_caps */
+  GstAvSyncTestCoverageMap coverage;
+#ifdef HAVE_CAIRO
+  /* paints into coverage when the cairo rasterizer is selected */
   cairo_surface_t *surface;
   cairo_t *cairo;
+
+  /* the digits shaped once at digit_size, the labels are placed glyph by glyph from them */
+  double digit_size;
+  double digit_ascent;
+  gulong digit_glyphs[10];
+  double digit_advances[10];
+#endif
+
+  /* pre-rendered frame variants for the current caps, and the colors they are rendered in */
+  GPtrArray *frame_variants;
+  guint variant_foreground_color;
+  guint variant_background_color;
+
+  /* coverage-map of every variant, recolored into frame_variants on color changes */
+  GPtrArray *variant_coverage;
+
+  /* per variant the region that differs from the background variant */
+  GstAvSyncTestDirtyRegion *variant_regions;
+
+  /* incremented whenever the variants are rendered, tags filled buffers */
+  guint variant_generation;
+
+  /* when and how the sync-points are shown, from the sync-interval and sync-pattern properties */
+  GstClockTime sync_interval;
+  guint sync_interval_frames;
+  GstAvSyncTestSyncPattern sync_pattern;
+  GstAvSyncTestTimeline timeline;
+
+  /*
+   * index into frame_variants for every n_frames % schedule_length, NULL
+   * when the timeline repeats too rarely and every frame is looked up instead
+   */
+  guint8 *frame_schedule;
+  gint schedule_length;
+
+  /* entry of the process-wide variant store the current variants are shared through */
+  GstAvSyncTestVariantEntry *shared_variants;
+
+  /* frame variants of recently negotiated caps and colors */
+  GstAvSyncTestVariantCache variant_cache;
+  guint64 variant_cache_size;
+
+  /*
+   * one period of the schedule encoded into encoded_caps, NULL for raw caps.
+   * Intra-only formats hold every variant once instead.
+   */
+  GstCaps *encoded_caps;
+  GPtrArray *encoded_frames;
+  gboolean encoded_intra_only;
+
+  /* re-encodes the variants in new colors off the streaming-thread, swapped in once done */
+  GThread *encode_thread;
+  GstAvSyncTestVideoSrcEncodeJob *encode_job;
+
+  /* band carrying the frame-counter, painted and rendered into every frame */
+  gboolean timecode;
+  GstAvSyncTestCoverageMap timecode_coverage;
+  GstAvSyncTestPalette timecode_palette;
+  guint timecode_generation;
+
+  /* hands out buffers sharing the memory of frame_variants in zero-copy mode */
+  GstBufferPool *frame_pool;
+
+  /* sync-points queued for consumers draining them from another thread */
+  GstAvSyncTestSyncRing sync_ring;
+  gboolean emit_signals;
+
+  /* renders and copies the frames in horizontal slices, re-created in set_caps */
+  guint n_threads;
+  GstAvSyncTestSliceRunner *slice_runner;
 };
 
 struct _GstAvSyncTestVideoSrcClass
 {
   GstPushSrcClass base_avsynctestvideosrc_class;
 
-  void (*sync_point) (GstElement * element);
+  void (*sync_point) (GstElement * element, GstClockTime pts, GstClockTime running_time, guint64 frame);
+
+  /* actions */
+  GstStructure *(*pull_sync_point) (GstAvSyncTestVideoSrc * avsynctestvideosrc);
 };
 
 GType gst_avsynctestvideosrc_get_type (void);
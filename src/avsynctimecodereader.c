@@ -0,0 +1,198 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "avsynctimecodereader.h"
+#include "avsynctestrender.h"
+#include "avsynctesttimecode.h"
+
+/* pad templates */
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw,format=" GST_AV_SYNC_TEST_RENDER_FORMATS)
+);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw,format=" GST_AV_SYNC_TEST_RENDER_FORMATS)
+);
+
+GST_DEBUG_CATEGORY_STATIC (gst_avsynctimecodereader_debug);
+#define GST_CAT_DEFAULT gst_avsynctimecodereader_debug
+
+/* properties */
+enum
+{
+  PROP_0,
+  PROP_LATENCY,
+  PROP_FRAMES,
+};
+
+/* parent class */
+#define gst_avsynctimecodereader_parent_class parent_class
+G_DEFINE_TYPE (GstAvSyncTimecodeReader, gst_avsynctimecodereader, GST_TYPE_VIDEO_FILTER);
+
+/* GObject member methods */
+static void gst_avsynctimecodereader_get_property (GObject * object, guint prop_id, GValue * value, GParamSpec * pspec);
+
+/* GstBaseTransform member methods */
+static gboolean gst_avsynctimecodereader_start (GstBaseTransform * trans);
+
+/* GstVideoFilter member methods */
+static GstFlowReturn gst_avsynctimecodereader_transform_frame_ip (GstVideoFilter * filter, GstVideoFrame * frame);
+
+static void
+gst_avsynctimecodereader_class_init (GstAvSyncTimecodeReaderClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  gobject_class->get_property = gst_avsynctimecodereader_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_LATENCY,
+      g_param_spec_int64 ("latency", "Latency",
+          "Latency of the last read Frame in ns, from its PTS at the Source to its Running-Time here.",
+          G_MININT64, G_MAXINT64,
+          0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_FRAMES,
+      g_param_spec_uint64 ("frames", "Frames",
+          "Number of Frames whose Timecode was read so far.",
+          0, G_MAXUINT64,
+          0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  GstBaseTransformClass *trans_class = GST_BASE_TRANSFORM_CLASS (klass);
+  trans_class->start = GST_DEBUG_FUNCPTR (gst_avsynctimecodereader_start);
+
+  GstVideoFilterClass *filter_class = GST_VIDEO_FILTER_CLASS (klass);
+  filter_class->transform_frame_ip = GST_DEBUG_FUNCPTR (gst_avsynctimecodereader_transform_frame_ip);
+
+  GST_DEBUG_CATEGORY_INIT (gst_avsynctimecodereader_debug, "avsynctimecodereader", 0, "AV Sync Timecode-Reader");
+
+  gst_element_class_add_static_pad_template (element_class, &sinktemplate);
+  gst_element_class_add_static_pad_template (element_class, &srctemplate);
+
+  gst_element_class_set_static_metadata (element_class, "AV Sync Timecode-Reader",
+      "Filter/Analyzer/Video",
+      "Reads the Frame-Number of the AV Sync-Test Signal from every frame and measures its latency.",
+      "Peter Körner <peter@mazdermind.de>");
+}
+
+static void
+gst_avsynctimecodereader_init (GstAvSyncTimecodeReader * avsynctimecodereader)
+{
+  GST_DEBUG_OBJECT (avsynctimecodereader, "init");
+
+  // the frames are only looked at
+  gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (avsynctimecodereader), TRUE);
+}
+
+void
+gst_avsynctimecodereader_get_property (GObject * object, guint property_id, GValue * value, GParamSpec * pspec)
+{
+  GstAvSyncTimecodeReader *avsynctimecodereader = GST_AV_SYNC_TIMECODE_READER (object);
+
+  switch (property_id) {
+    case PROP_LATENCY:
+      GST_OBJECT_LOCK (avsynctimecodereader);
+      g_value_set_int64 (value, avsynctimecodereader->latency);
+      GST_OBJECT_UNLOCK (avsynctimecodereader);
+      break;
+
+    case PROP_FRAMES:
+      GST_OBJECT_LOCK (avsynctimecodereader);
+      g_value_set_uint64 (value, avsynctimecodereader->frames);
+      GST_OBJECT_UNLOCK (avsynctimecodereader);
+      break;
+
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (avsynctimecodereader, property_id, pspec);
+      break;
+  }
+}
+
+static gboolean
+gst_avsynctimecodereader_start (GstBaseTransform * trans)
+{
+  GstAvSyncTimecodeReader *avsynctimecodereader = GST_AV_SYNC_TIMECODE_READER (trans);
+
+  GST_OBJECT_LOCK (avsynctimecodereader);
+  avsynctimecodereader->latency = 0;
+  avsynctimecodereader->frames = 0;
+  GST_OBJECT_UNLOCK (avsynctimecodereader);
+
+  return TRUE;
+}
+
+/*
+ * The source timestamps frame n at n / framerate from the start of its
+ * segment, so this is where the frame was generated. The difference to the
+ * running-time here is the latency of everything in between, with the
+ * precision of the timestamps the frame arrived with, e.g. of a capture.
+ */
+static GstFlowReturn
+gst_avsynctimecodereader_transform_frame_ip (GstVideoFilter * filter, GstVideoFrame * frame)
+{
+  GstAvSyncTimecodeReader *avsynctimecodereader = GST_AV_SYNC_TIMECODE_READER (filter);
+  GstBuffer *buffer = frame->buffer;
+
+  GstClockTime running_time = gst_segment_to_running_time (&GST_BASE_TRANSFORM (filter)->segment,
+      GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
+
+  if (!GST_CLOCK_TIME_IS_VALID (running_time) || GST_VIDEO_INFO_FPS_N (&filter->in_info) <= 0) {
+    GST_LOG_OBJECT (avsynctimecodereader, "skipping frame without running-time or framerate");
+    return GST_FLOW_OK;
+  }
+
+  guint32 frame_index;
+  if (!gst_avsynctest_timecode_read (frame, &frame_index)) {
+    GST_LOG_OBJECT (avsynctimecodereader, "no timecode in frame at %" GST_TIME_FORMAT, GST_TIME_ARGS (running_time));
+    return GST_FLOW_OK;
+  }
+
+  GstClockTime generated = gst_util_uint64_scale (frame_index,
+      GST_VIDEO_INFO_FPS_D (&filter->in_info) * GST_SECOND, GST_VIDEO_INFO_FPS_N (&filter->in_info));
+  gint64 latency = GST_CLOCK_DIFF (generated, running_time);
+
+  GST_OBJECT_LOCK (avsynctimecodereader);
+  avsynctimecodereader->latency = latency;
+  avsynctimecodereader->frames++;
+  GST_OBJECT_UNLOCK (avsynctimecodereader);
+
+  GST_LOG_OBJECT (avsynctimecodereader, "frame %u at %" GST_TIME_FORMAT ", latency %" G_GINT64_FORMAT " ns",
+      frame_index, GST_TIME_ARGS (running_time), latency);
+
+  gst_element_post_message (GST_ELEMENT (avsynctimecodereader),
+      gst_message_new_element (GST_OBJECT (avsynctimecodereader),
+          gst_structure_new ("avsynctimecodereader",
+              "frame", G_TYPE_UINT64, (guint64) frame_index,
+              "latency", G_TYPE_INT64, latency,
+              "running-time", G_TYPE_UINT64, running_time,
+              NULL)));
+
+  return GST_FLOW_OK;
+}
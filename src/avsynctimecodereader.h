@@ -0,0 +1,51 @@
+/* GStreamer
+ * Copyright (C) 2019 Peter Körner <peter@mazdermind.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Suite 500,
+ * Boston, MA 02110-1335, USA.
+ */
+#ifndef _GST_AV_SYNC_TIMECODE_READER_H_
+#define _GST_AV_SYNC_TIMECODE_READER_H_
+
+#include <gst/video/video.h>
+#include <gst/video/gstvideofilter.h>
+
+G_BEGIN_DECLS
+#define GST_TYPE_AV_SYNC_TIMECODE_READER           (gst_avsynctimecodereader_get_type())
+#define GST_AV_SYNC_TIMECODE_READER(obj)           (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_AV_SYNC_TIMECODE_READER, GstAvSyncTimecodeReader))
+#define GST_AV_SYNC_TIMECODE_READER_CLASS(klass)   (G_TYPE_CHECK_CLASS_CAST((klass),  GST_TYPE_AV_SYNC_TIMECODE_READER, GstAvSyncTimecodeReaderClass))
+#define GST_IS_AV_SYNC_TIMECODE_READER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_AV_SYNC_TIMECODE_READER))
+#define GST_IS_AV_SYNC_TIMECODE_READER_CLASS(obj)  (G_TYPE_CHECK_CLASS_TYPE((klass),  GST_TYPE_AV_SYNC_TIMECODE_READER))
+typedef struct _GstAvSyncTimecodeReader GstAvSyncTimecodeReader;
+typedef struct _GstAvSyncTimecodeReaderClass GstAvSyncTimecodeReaderClass;
+
+struct _GstAvSyncTimecodeReader
+{
+  GstVideoFilter base_avsynctimecodereader;
+
+  // last measurement, protected by the object lock
+  gint64 latency;
+  guint64 frames;
+};
+
+struct _GstAvSyncTimecodeReaderClass
+{
+  GstVideoFilterClass base_avsynctimecodereader_class;
+};
+
+GType gst_avsynctimecodereader_get_type (void);
+
+G_END_DECLS
+#endif // _GST_AV_SYNC_TIMECODE_READER_H_